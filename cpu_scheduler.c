@@ -1,12 +1,84 @@
+#define _POSIX_C_SOURCE 200809L
+
+#ifdef SCHED_PERF
+#define _GNU_SOURCE
+#define SCHED_INSTRUMENT
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
 #include <time.h>
 #include <float.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
+#include <math.h>
+#include <errno.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MONITOR_SUPPORTED
+#define PARALLEL_SUPPORTED
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#include <direct.h>
+#define make_directory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define make_directory(path) mkdir(path, 0755)
+#endif
+#include <dirent.h>
+
+#ifdef SCHED_PERF
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #define MAX_PROCESSES 100
 #define MAX_QUEUES 5
+#define NUM_CLASSES 3
+#define MLQ_STRIDE 1000000
+#define MAX_CORES 16
+#define MIGRATE_MIN_WORK 5      // Work units left before a job is worth migrating
+#define MIN_CORE_SPEED 0.001    // Slowest core that still does one thousandth per tick
+#define CHECKPOINT_FILE "scheduler_checkpoint.bin"
+#define CHECKPOINT_MAGIC 0x43505343u  // "CSPC"
+#define CHECKPOINT_VERSION 4
+#define SIM_VERSION 2           // Bump when any engine's results change (invalidates the cache)
+#define CACHE_DIR ".sched_cache"
+#define CACHE_MAGIC 0x32484353u  // "SCH2"
+#define CACHE_MAX_PARAMS 16
+#define TEST_WORKLOAD_SEED 20240u // Comprehensive test workloads, so reruns hit the cache
+#define MAX_GENERATED_BURST 1000000
+#define WORKLOAD_PI 3.14159265358979323846
+#define WORKLOAD_WRITE_BUFFER (1 << 20)
+#define WORKLOAD_CHUNK 16384     // Processes per parallel generation chunk
+#define WORKLOAD_LINE_MAX 48     // Longest formatted workload line
+#define MAX_WORKLOAD_WORKERS 64
+#define TRACE_TASK_SLOTS 65536   // Power of two
+#define TRACE_LINE_MAX 4096
+#define MONITOR_SOCKET "cpu_scheduler_monitor.sock"   // In the per-user runtime directory
+#define MONITOR_MAGIC 0x4D4F4E32u  // "MON2"
+#define MONITOR_INTERVAL_MS 250
+#define PROGRESS_CHECK_EVENTS 64
+#define LATENCY_SUB_BUCKETS 32
+#define LATENCY_BUCKETS (LATENCY_SUB_BUCKETS * 40)
+#define OPEN_MIN_BATCHES 30     // Batch means needed before the CI is trusted
+#define OPEN_Z95 1.96
+#define MAX_ORACLE_WORKERS 256
+#define MAX_GANG_CPUS 4096
+#define GANG_SLOWDOWN_TAU 10    // Runtime floor for bounded slowdown
 
 // Process Control Block structure
 typedef struct {
@@ -21,6 +93,8 @@ typedef struct {
     int response_time;
     bool first_response;
     int queue_level;  // For MLFQ
+    int proc_class;   // For multilevel queue (CLASS_*)
+    int width;        // CPUs needed at once (gang scheduling)
 } Process;
 
 // Performance Metrics structure
@@ -33,28 +107,703 @@ typedef struct {
     int total_time;
 } Metrics;
 
+// Process classes for the multilevel queue (lower = more important)
+typedef enum {
+    CLASS_SYSTEM = 0,
+    CLASS_INTERACTIVE,
+    CLASS_BATCH
+} ProcessClass;
+
+// Per-class policies and share enforcement for the multilevel queue
+typedef enum {
+    MLQ_RR = 1,
+    MLQ_FCFS,
+    MLQ_SJF,
+    MLQ_SRTF
+} MLQPolicy;
+
+typedef enum {
+    MLQ_STRICT = 1,     // Higher class always runs first
+    MLQ_WEIGHTED        // Time sliced between classes by share
+} MLQMode;
+
+typedef struct {
+    int mode;
+    int policy[NUM_CLASSES];
+    int quantum[NUM_CLASSES];   // RR only
+    int share[NUM_CLASSES];     // Percent of CPU (weighted mode)
+} MLQConfig;
+
+// Heterogeneous cores: placement policies and core classes
+typedef enum {
+    PLACE_FASTEST = 1,      // Global queue, idle big cores served first
+    PLACE_PROPORTIONAL,     // Per-core queues, placed by backlog / speed
+    PLACE_MIGRATE           // Fastest-available plus migrating long jobs to big cores
+} Placement;
+
+typedef enum {
+    CORE_LITTLE = 0,
+    CORE_BIG
+} CoreClass;
+
+typedef struct {
+    int big_cores;
+    double big_speed;       // Work units per time unit
+    int little_cores;
+    double little_speed;
+    int placement;
+} CoreConfig;
+
+// Per-core-class results of a heterogeneous run
+typedef struct {
+    long long busy_time[2];
+    double utilization[2];  // Percent of that class's core-time
+    int jobs[2];            // Jobs finished on that class
+    int class_p50[2], class_p90[2];
+    int p50, p90, p99;      // Turnaround over all jobs
+    int migrations;
+} CoreStats;
+
+// Algorithm identifiers (stored in checkpoints)
+typedef enum {
+    ALG_FCFS = 1,
+    ALG_SJF,
+    ALG_PRIORITY,
+    ALG_RR,
+    ALG_SRTF,
+    ALG_MLFQ
+} Algorithm;
+
+// Differential oracle tallies, indexed by algorithm
+typedef struct {
+    long long tested;
+    long long failures[ALG_MLFQ + 1];
+    uint64_t first_failure[ALG_MLFQ + 1];   // Lowest diverging seed
+} OracleResult;
+
+// Gang scheduling policies for parallel jobs
+typedef enum {
+    GANG_FCFS = 1,          // Strict queue order, head blocks everyone
+    GANG_EASY,              // FCFS plus EASY backfilling behind one reservation
+    GANG_FIRST_FIT          // Earliest-queued job that fits, no reservation
+} GangPolicy;
+
+// Parallel job: needs width CPUs at once for runtime time units
+typedef struct {
+    int id;
+    long long arrival;
+    long long runtime;
+    int width;
+    long long start, end;   // -1 until scheduled
+    int bucket, slot;       // Position in the scheduler's width buckets
+} GangJob;
+
+// Segment tree of minima over a fixed number of positions
+typedef struct {
+    long long *value;       // 2 * size nodes, root at 1
+    int size;               // Leaves, a power of two
+} MinTree;
+
+// Waiting jobs of one width: tree leaves hold the runtime of each job
+// still waiting (LLONG_MAX otherwise), in queue order
+typedef struct {
+    int width;
+    int count;
+    int *jobs;              // Job index per position
+    MinTree tree;
+} GangBucket;
+
+typedef struct {
+    long long end;
+    int width;
+    int job;
+} RunningJob;
+
+typedef struct {
+    GangJob *jobs;          // Sorted by arrival, so index = queue order
+    int arrived;            // Jobs [0, arrived) have been submitted
+    int head;               // Earliest waiting job (== arrived when none)
+    int waiting;
+    int free;               // Idle CPUs
+    GangBucket *buckets;    // Ascending width
+    int bucket_count;
+    RunningJob *running;    // Sorted by end time, latest first
+    int running_count;
+} GangScheduler;
+
+typedef struct {
+    long long jobs;
+    long long makespan;
+    double utilization;     // Busy CPU-time, percent of cpus * makespan
+    double fragmentation;   // Idle CPU-time while jobs wait, same scale
+    double avg_waiting, avg_turnaround;
+    double avg_slowdown, max_slowdown;
+    long long backfilled;   // Started ahead of an earlier-queued job
+    int max_waiting;
+} GangStats;
+
+// Ready queue entry (RR uses pid_idx only, MLFQ also tracks the level)
+typedef struct {
+    int pid_idx;
+    int queue_level;
+} QueueItem;
+
+// Complete engine state. Every engine keeps its loop state here instead of
+// in locals so a run can be written to a checkpoint and resumed later.
+// Covers the six original engines on up to MAX_PROCESSES processes; the
+// later engines and the streaming/open-system runs are not checkpointed.
+typedef struct {
+    int algorithm;
+    int n;
+    int quantum;             // RR only
+    int current_time;
+    int completed;
+    int front, rear;         // Ready queue bounds (RR ring buffer, MLFQ list)
+    int queue_cap;           // n + 1 slots
+    QueueItem queue[MAX_PROCESSES + 1];
+    bool flag[MAX_PROCESSES];   // visited (SJF/Priority) or in_queue (RR/MLFQ)
+    Process proc[MAX_PROCESSES];
+    int next_checkpoint;     // Not saved: recomputed on resume
+} SimState;
+
+// Fixed-size checkpoint header, followed by queue[queue_cap], flag[n] (one byte each), proc[n]
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t algorithm;
+    int32_t n;
+    int32_t quantum;
+    int32_t current_time;
+    int32_t completed;
+    int32_t front;
+    int32_t rear;
+    int32_t queue_cap;
+} CheckpointHeader;
+
+// Workload generator models
+typedef enum {
+    ARRIVAL_POISSON = 1,
+    ARRIVAL_MMPP,
+    ARRIVAL_DIURNAL
+} ArrivalModel;
+
+typedef enum {
+    BURST_PARETO = 1,
+    BURST_LOGNORMAL,
+    BURST_BIMODAL
+} BurstModel;
+
+// Workload generator parameters
+typedef struct {
+    int arrival_model;
+    int burst_model;
+    double target_utilization;   // Offered load on one CPU
+    double mean_burst;           // Pareto / lognormal mean
+    double pareto_alpha;         // Tail index (> 1)
+    double lognormal_sigma;
+    double bimodal_short;        // Mean of the short mode
+    double bimodal_long;         // Mean of the long mode
+    double bimodal_long_fraction;
+    double mmpp_rate_ratio;      // High-state rate / low-state rate
+    double mmpp_mean_dwell;      // Mean time spent in each MMPP state
+    double diurnal_period;
+    double diurnal_amplitude;    // 0-1, fraction of the mean rate
+    uint64_t seed;
+} WorkloadSpec;
+
+// Sequential generator state: arrivals come out in time order
+typedef struct {
+    WorkloadSpec spec;
+    uint64_t rng;
+    double clock;
+    double rate;                 // Mean arrival rate
+    double mean_burst;
+    int mmpp_state;              // 0 = low, 1 = high
+    double mmpp_low_rate;
+    double mmpp_high_rate;
+    double mmpp_switch_time;
+    long long generated;
+} WorkloadGenerator;
+
+// Open-system policies
+typedef enum {
+    OPEN_FCFS = 1,
+    OPEN_SJF,
+    OPEN_PRIORITY,
+    OPEN_RR,
+    OPEN_SRTF
+} OpenPolicy;
+
+typedef struct {
+    int policy;
+    int quantum;                 // RR only
+    long long warmup_time;       // Jobs arriving earlier are not measured
+    long long time_limit;
+    double target_precision;     // CI half-width as a fraction of the mean
+    long long batch_size;        // Jobs per batch mean
+} OpenConfig;
+
+// In-flight job of an open-system run. Times are 64-bit: long runs pass
+// INT_MAX time units
+typedef struct {
+    long long seq;               // Arrival order
+    long long arrival;
+    long long remaining;
+    long long first_run;         // -1 until first dispatched
+    int burst;
+    int priority;
+} OpenJob;
+
+// Slots for in-flight jobs, grown by doubling and reused through a free list
+typedef struct {
+    OpenJob *jobs;
+    int *free_slots;
+    int capacity;
+    int free_count;
+    int in_use;
+} JobPool;
+
+// Welford accumulator
+typedef struct {
+    long long count;
+    double mean;
+    double m2;
+} RunningStat;
+
+// Open-system results: fixed size regardless of jobs simulated
+typedef struct {
+    RunningStat waiting, turnaround, response;
+    RunningStat batch_means;     // Of turnaround
+    double batch_sum;
+    long long batch_fill;
+    long long turnaround_hist[LATENCY_BUCKETS];
+    long long arrivals;
+    long long completed;
+    long long discarded;         // Completed, but arrived during warmup
+    long long busy_time;         // After warmup
+    double area_in_system;       // Integral of jobs in system after warmup
+    long long end_time;
+    double ci_half_width;
+    bool converged;
+    int peak_in_flight;
+    int in_flight_at_end;
+    int pool_capacity;
+} OpenStats;
+
+// Buffered writer for workload files
+typedef struct {
+    FILE *fp;
+    char *buffer;
+    char *out;
+    long long written;
+    bool failed;
+} WorkloadWriter;
+
+// Per-task state while replaying a scheduler trace
+typedef struct {
+    int pid;
+    bool used;
+    bool in_job;         // Woken up and not yet blocked again
+    bool running;
+    int prio;
+    double arrival;      // Seconds since trace start
+    double run;          // Seconds on CPU in the current job
+    double running_since;
+} TraceTask;
+
+// Streaming trace import state
+typedef struct {
+    TraceTask *tasks;    // TRACE_TASK_SLOTS entries, tasks with a job in progress
+    int task_count;
+    int peak_tasks;
+    WorkloadWriter writer;
+    double time_unit;    // Seconds per simulator time unit
+    double first_ts, last_ts;
+    bool have_first_ts;
+    long long lines, events, malformed, dropped;
+} TraceImport;
+
+// Binary min-heap entry: ordered by key, then tie
+typedef struct {
+    long long key;
+    long long tie;
+    int idx;
+} HeapNode;
+
+// Growable binary min-heap
+typedef struct {
+    HeapNode *nodes;
+    int size;
+    int capacity;
+} MinHeap;
+
+// Snapshot datagram published to the live monitor
+typedef struct {
+    uint32_t magic;
+    char phase[48];
+    long long sim_time;
+    long long completed;
+    long long total;             // 0 when unknown (trace import)
+    double avg_waiting;
+    double avg_turnaround;
+    double avg_response;
+    double p50_turnaround;
+    double p95_turnaround;
+    double p99_turnaround;
+    double events_per_sec;
+    long long memory_kb;
+    int32_t memory_is_peak;      // Peak resident size where /proc is missing
+} ProgressSnapshot;
+
+// Publisher state: running sums for the current phase only, so memory is
+// fixed no matter how many processes complete
+typedef struct {
+    char context[32];            // Prefix such as the comprehensive test name
+    char phase[48];
+    long long total;
+    long long completed;
+    long long events;
+    long long sim_time;
+    double sum_waiting, sum_turnaround, sum_response;
+    long long turnaround_hist[LATENCY_BUCKETS];
+    long long events_at_publish;
+    double last_publish;         // Monotonic seconds
+    int fd;                      // -1 until first use
+} ProgressState;
+
+// Live monitor publishing (toggled from the menu)
+bool monitor_enabled = false;
+ProgressState progress = {.fd = -1};
+
+// Simulated time units between checkpoints (0 = disabled)
+int checkpoint_interval = 0;
+#ifdef PARALLEL_SUPPORTED
+pid_t checkpoint_writer = -1;   // Child still writing a snapshot, or -1
+#endif
+
+// Everything a cached run depends on. Entries store it and lookups
+// compare it, so a hash collision is a miss rather than a wrong result.
+// input[] is pid, arrival, burst, priority, class and width.
+typedef struct {
+    uint64_t hash;
+    char policy[32];
+    int32_t nparams;
+    int32_t params[CACHE_MAX_PARAMS];
+    int32_t n;
+    int32_t input[MAX_PROCESSES][6];
+} CacheKey;
+
+// Result cache entry: header, the used part of the CacheKey, n output
+// Process records if has_processes, then extra_size bytes of
+// engine-specific results. File name is the hash in hex.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;       // SIM_VERSION that produced the entry
+    uint64_t key;
+    int32_t n;
+    int32_t has_processes;
+    int32_t extra_size;
+    Metrics metrics;
+} CacheHeader;
+
+// Outcome of a lookup. A metrics-only hit leaves processes[] untouched
+typedef enum {
+    CACHE_MISS,
+    CACHE_HIT_METRICS,
+    CACHE_HIT
+} CacheResult;
+
+// MLQ per-class results, cached with the run
+typedef struct {
+    Metrics metrics[NUM_CLASSES];
+    int counts[NUM_CLASSES];
+} MLQClassResults;
+
+typedef struct {
+    long long hits;
+    long long misses;
+    long long stores;
+    long long errors;
+} CacheStats;
+
+// Cached runs carry no engine counters, so instrumented builds start with
+// the cache off
+#ifdef SCHED_INSTRUMENT
+bool cache_enabled = false;
+#else
+bool cache_enabled = true;
+#endif
+bool cache_store_processes = true;
+CacheStats cache_stats;
+
+// Engine instrumentation. Build with -DSCHED_INSTRUMENT (make instrument)
+// for per-run counters, or -DSCHED_PERF (make perf) to also read hardware
+// counters through perf_event_open. Without either flag every hook below
+// compiles to nothing.
+#ifdef SCHED_INSTRUMENT
+#define READY_HIST_BUCKETS 16   // Last bucket collects longer queues
+
+typedef struct {
+    long long dispatches;        // Scheduling decisions that ran a process
+    long long preemptions;       // Unfinished process taken off the CPU
+    long long queue_scans;       // Process entries examined by linear scans
+    long long heap_ops;          // Heap pushes and pops
+    int max_ready;               // Longest ready queue seen
+    long long ready_time[READY_HIST_BUCKETS];  // Simulated time per queue length
+    bool hw_valid;
+    long long cycles, instructions, cache_misses, branch_misses;
+} Counters;
+
+Counters counters;
+
+void instr_begin();
+void instr_end();
+void instr_ready(int length, long long duration);
+void print_counters(FILE *fp);
+void write_counters_csv_header(FILE *fp);
+void write_counters_csv(FILE *fp);
+
+#define INSTR_BEGIN() instr_begin()
+#define INSTR_END() instr_end()
+#define INSTR_DISPATCH() (counters.dispatches++)
+#define INSTR_PREEMPT() (counters.preemptions++)
+#define INSTR_SCAN(k) (counters.queue_scans += (k))
+#define INSTR_HEAP() (counters.heap_ops++)
+#define INSTR_READY(length, duration) instr_ready((length), (duration))
+#define INSTR_PRINT(fp) print_counters(fp)
+#define INSTR_CSV_HEADER(fp) write_counters_csv_header(fp)
+#define INSTR_CSV(fp) write_counters_csv(fp)
+#else
+// sizeof keeps the arguments "used" without evaluating them
+#define INSTR_BEGIN() ((void)0)
+#define INSTR_END() ((void)0)
+#define INSTR_DISPATCH() ((void)0)
+#define INSTR_PREEMPT() ((void)0)
+#define INSTR_SCAN(k) ((void)sizeof(k))
+#define INSTR_HEAP() ((void)0)
+#define INSTR_READY(length, duration) ((void)sizeof((length) + (duration)))
+#define INSTR_PRINT(fp) ((void)sizeof(fp))
+#define INSTR_CSV_HEADER(fp) ((void)sizeof(fp))
+#define INSTR_CSV(fp) ((void)sizeof(fp))
+#endif
+
 // Function prototypes
 void display_menu();
 void input_processes(Process processes[], int *n);
 void generate_test_workload(Process processes[], int *n, int type);
+void fill_test_workload(Process processes[], int n, int type, unsigned int seed);
 void fcfs(Process processes[], int n, Metrics *metrics);
 void sjf(Process processes[], int n, Metrics *metrics);
 void priority_scheduling(Process processes[], int n, Metrics *metrics);
 void round_robin(Process processes[], int n, int quantum, Metrics *metrics);
 void srtf(Process processes[], int n, Metrics *metrics);
 void mlfq(Process processes[], int n, Metrics *metrics);
+void priority_preemptive(Process processes[], int n, int aging_interval, Metrics *metrics);
+void multilevel_queue(Process processes[], int n, const MLQConfig *config,
+                      Metrics *metrics, Metrics class_metrics[], int class_counts[]);
+int classify_process(int burst, int priority);
+const char *class_name(int proc_class);
+const char *mlq_policy_name(int policy);
+void mlq_default_config(MLQConfig *config);
+void arrival_order(Process proc[], int n, int order[]);
+const char *placement_name(int placement);
+int compare_ints(const void *a, const void *b);
+int percentile_of_sorted(const int values[], int count, double pct);
+void heterogeneous_cores(Process processes[], int n, const CoreConfig *config,
+                         Metrics *metrics, CoreStats *stats);
+void print_core_stats(FILE *fp, const CoreConfig *config, const CoreStats *stats);
+void heterogeneous_menu(Process processes[], int n);
+int mlq_take(int queue[], int *count, int pos);
+void mlq_class_metrics(const Process proc[], int n, int total_time,
+                       Metrics class_metrics[], int class_counts[]);
+void print_class_metrics(FILE *fp, const MLQConfig *config,
+                         const Metrics class_metrics[], const int class_counts[]);
+void save_class_metrics(const MLQConfig *config, const Metrics class_metrics[], const int class_counts[]);
+bool configure_mlq(MLQConfig *config);
 void calculate_metrics(Process processes[], int n, int total_time, Metrics *metrics);
 void print_results(Process processes[], int n, Metrics metrics, const char *algorithm);
 void save_to_file(Process processes[], int n, Metrics metrics, const char *algorithm);
+void write_comparison_row(FILE *fp, const char *test_name, int workload,
+                          const char *algorithm, Metrics metrics);
+int latency_bucket(long long v);
+long long latency_bucket_value(int bucket);
+double latency_percentile(const long long hist[], long long count, double pct);
+double monotonic_seconds();
+long long memory_in_use_kb(bool *is_peak);
+bool monitor_socket_path(char *path, size_t size, bool create);
+void progress_set_context(const char *context);
+void progress_begin(const char *phase, long long total);
+void progress_reset(const char *phase, long long total);
+void progress_publish();
+void progress_maybe_publish();
+void progress_add(const Process *p);
+void progress_complete(const Process *p);
+void progress_restore(const char *phase, const Process proc[], int n);
+void progress_tick(long long completed, long long sim_time);
+void progress_end();
+void toggle_monitor();
+int monitor_main();
 void run_comprehensive_tests();
 void display_gantt_chart(int pid_sequence[], int time_sequence[], int sequence_length);
+uint64_t rng_next(uint64_t *state);
+double rng_uniform(uint64_t *state);
+double rng_exponential(uint64_t *state, double rate);
+double rng_normal(uint64_t *state);
+void workload_spec_defaults(WorkloadSpec *spec);
+void workload_init(WorkloadGenerator *gen, const WorkloadSpec *spec);
+double workload_next_arrival(WorkloadGenerator *gen);
+int workload_next_burst(WorkloadGenerator *gen);
+void workload_next(WorkloadGenerator *gen, Process *p);
+char *append_number(char *out, long long v);
+uint64_t rng_apply(const uint64_t matrix[64], uint64_t x);
+void rng_jump(uint64_t *state, unsigned long long steps);
+int workload_draws(const WorkloadSpec *spec);
+double workload_chunk(const WorkloadGenerator *base, long long first, long long count,
+                      double offset, char *out, char **end);
+char *workload_format_line(char *out, long long arrival, int burst, int priority, int proc_class);
+bool workload_writer_open(WorkloadWriter *w, const char *filename);
+void workload_writer_put(WorkloadWriter *w, long long arrival, int burst, int priority, int proc_class);
+void workload_writer_append(WorkloadWriter *w, const char *data, size_t len, long long lines);
+bool workload_writer_close(WorkloadWriter *w);
+long long stream_workload_file(const char *filename, const WorkloadSpec *spec, long long count,
+                               int workers);
+bool stream_chunks(WorkloadWriter *writer, const WorkloadGenerator *base, long long count);
+bool stream_chunks_parallel(WorkloadWriter *writer, const WorkloadGenerator *base,
+                            long long count, int workers);
+#ifdef PARALLEL_SUPPORTED
+bool workers_wait(int fd, int count);
+bool workers_release(const int go[], int count);
+#endif
+bool parse_workload_line(const char *line, Process *p);
+bool load_workload_file(const char *filename, Process processes[], int *n);
+int compare_arrival_pid(const void *a, const void *b);
+bool load_earliest_arrivals(const char *filename, Process processes[], int *n);
+bool read_workload_spec(WorkloadSpec *spec);
+void generate_advanced_workload(Process processes[], int *n);
+const char *open_policy_name(int policy);
+void stat_add(RunningStat *s, double x);
+double stat_stddev(const RunningStat *s);
+bool pool_init(JobPool *pool, int capacity);
+void pool_free(JobPool *pool);
+int pool_alloc(JobPool *pool);
+void pool_release(JobPool *pool, int slot);
+bool open_enqueue(MinHeap *ready, const OpenJob *job, int slot, int policy, long long *enqueue_seq);
+bool open_system(const WorkloadSpec *spec, const OpenConfig *config, OpenStats *stats);
+void print_open_stats(FILE *fp, const WorkloadSpec *spec, const OpenConfig *config,
+                      const OpenStats *stats);
+void open_system_menu();
+void load_workload_menu(Process processes[], int *n);
+const char *trace_field(const char *s, const char *key);
+const char *trace_task_ref(const char *s, int *pid, int *prio);
+bool trace_timestamp(const char *line, const char *event, double *ts);
+unsigned int trace_slot(int pid);
+TraceTask *trace_task(TraceImport *imp, int pid, bool create);
+void trace_task_remove(TraceImport *imp, TraceTask *t);
+int trace_priority(int prio);
+int trace_class(int prio);
+void trace_start_job(TraceImport *imp, TraceTask *t, double ts, int prio);
+void trace_emit_job(TraceImport *imp, TraceTask *t);
+void trace_handle_line(TraceImport *imp, const char *line);
+bool import_sched_trace(const char *trace_file, const char *workload_file,
+                        double time_unit_us, TraceImport *imp);
+void import_trace_menu(Process processes[], int *n);
 void sort_by_arrival(Process processes[], int n);
 void reset_processes(Process original[], Process copy[], int n);
+void sim_init(SimState *st, int algorithm, Process processes[], int n, int quantum);
+void sim_finish(SimState *st, Process processes[], Metrics *metrics);
+void fcfs_run(SimState *st);
+void sjf_run(SimState *st);
+void priority_run(SimState *st);
+void round_robin_run(SimState *st);
+void srtf_run(SimState *st);
+void mlfq_run(SimState *st);
+void fcfs_fast(Process processes[], int n, Metrics *metrics);
+void nonpreemptive_fast(Process processes[], int n, bool use_priority, Metrics *metrics);
+void sjf_fast(Process processes[], int n, Metrics *metrics);
+void priority_fast(Process processes[], int n, Metrics *metrics);
+void srtf_fast(Process processes[], int n, Metrics *metrics);
+int admit_by_index(const Process proc[], int n, const int order[], int *next,
+                   int current_time, int batch[]);
+void slice_fast(Process processes[], int n, int levels, int rr_quantum, Metrics *metrics);
+void round_robin_fast(Process processes[], int n, int quantum, Metrics *metrics);
+void mlfq_fast(Process processes[], int n, Metrics *metrics);
+void heap_init(MinHeap *h, int capacity);
+void heap_free(MinHeap *h);
+bool heap_less(const HeapNode *a, const HeapNode *b);
+bool heap_push(MinHeap *h, long long key, long long tie, int idx);
+HeapNode heap_pop(MinHeap *h);
+void checkpoint_poll(SimState *st);
+bool checkpoint_write_async(const SimState *st);
+void checkpoint_wait();
+bool save_checkpoint(const SimState *st);
+bool checkpoint_valid(const SimState *st);
+bool load_checkpoint(SimState *st);
+const char *algorithm_name(int algorithm);
+void resume_from_checkpoint(Process processes[], int *n);
+void configure_checkpointing();
+uint64_t fnv1a(uint64_t hash, const void *data, size_t len);
+void cache_key(CacheKey *key, const char *policy, const int params[], int nparams,
+               const Process processes[], int n);
+size_t cache_key_size(const CacheKey *key);
+void cache_path(uint64_t hash, char *path, size_t size);
+CacheResult cache_lookup(const CacheKey *key, Process processes[], int n, Metrics *metrics,
+                         void *extra, size_t extra_size);
+void cache_store(const CacheKey *key, const Process processes[], int n, const Metrics *metrics,
+                 const void *extra, size_t extra_size);
+CacheResult run_cached(int algorithm, Process processes[], int n, int quantum, Metrics *metrics);
+Process *cached_output(CacheResult hit, Process processes[]);
+CacheResult priority_preemptive_cached(Process processes[], int n, int aging, Metrics *metrics);
+CacheResult mlq_cached(Process processes[], int n, const MLQConfig *config, Metrics *metrics,
+                       Metrics class_metrics[], int class_counts[]);
+CacheResult heterogeneous_cached(Process processes[], int n, const CoreConfig *config,
+                                 Metrics *metrics, CoreStats *stats);
+int cache_scan(bool clear, long long *bytes);
+void print_cache_report(FILE *fp);
+void cache_menu();
+void oracle_run(int algorithm, bool fast, Process processes[], int n, int quantum, Metrics *metrics);
+void oracle_workload(uint64_t seed, Process processes[], int *n, int *quantum);
+int oracle_check(int algorithm, const Process workload[], int n, int quantum,
+                 Process reference[], Process fast[]);
+void oracle_minimize(int algorithm, Process workload[], int *n, int *quantum);
+void oracle_worker(uint64_t first, uint64_t end, uint64_t stride, OracleResult *result);
+void oracle_report(int algorithm, uint64_t seed);
+long long run_differential_tests(long long count, uint64_t seed, int workers);
+void oracle_merge(OracleResult *total, const OracleResult *result);
+void oracle_menu();
+const char *gang_policy_name(int policy);
+bool tree_init(MinTree *t, int count);
+void tree_set(MinTree *t, int pos, long long value);
+int tree_leftmost(const MinTree *t, long long limit);
+int compare_gang_jobs(const void *a, const void *b);
+int gang_pick(GangScheduler *g, int free, long long short_limit, int wide_ok);
+void gang_start(GangScheduler *g, int j, long long now);
+void gang_schedule(GangScheduler *g, int policy, long long now, GangStats *stats);
+bool gang_simulate(GangJob jobs[], int n, int cpus, int policy, GangStats *stats);
+bool gang_processes(Process processes[], int n, int cpus, int policy,
+                    Metrics *metrics, GangStats *stats);
+GangJob *load_gang_file(const char *filename, int *n);
+GangJob *generate_gang_jobs(int n, int cpus, double load, uint64_t seed);
+void print_gang_stats(FILE *fp, int cpus, int policy, const GangStats *stats);
+void gang_menu(Process processes[], int n);
 
 // Main function
-int main() {
+int main(int argc, char *argv[]) {
     Process processes[MAX_PROCESSES];
-    int n = 0, choice, quantum;
+    int n = 0, choice, quantum, aging;
+    MLQConfig mlq_config;
+    Metrics class_metrics[NUM_CLASSES];
+    int class_counts[NUM_CLASSES];
+
+    if (argc > 1 && strcmp(argv[1], "--monitor") == 0) {
+        return monitor_main();
+    }
+    if (argc > 2 && strcmp(argv[1], "--oracle") == 0) {
+        // --oracle COUNT [SEED] [WORKERS]: exit status 1 on any divergence
+        long long count = atoll(argv[2]);
+        uint64_t seed = argc > 3 ? strtoull(argv[3], NULL, 10) : 1;
+        int workers = argc > 4 ? atoi(argv[4]) : 0;
+        return run_differential_tests(count, seed, workers) > 0 ? 1 : 0;
+    }
 
     printf("\n");
     printf("╔════════════════════════════════════════════════════════════╗\n");
@@ -69,9 +818,14 @@ int main() {
     while (1) {
         display_menu();
         printf("Enter your choice: ");
-        scanf("%d", &choice);
+        if (scanf("%d", &choice) != 1) {
+            // End of input (e.g. piped commands): stop instead of looping
+            printf("\n");
+            return 0;
+        }
 
         Metrics metrics = {0};
+        Process *results;   // NULL after a metrics-only cache hit
 
         switch (choice) {
             case 1:
@@ -95,9 +849,9 @@ int main() {
                     printf("⚠ No processes loaded! Please add processes first.\n");
                     break;
                 }
-                fcfs(processes, n, &metrics);
-                print_results(processes, n, metrics, "FCFS");
-                save_to_file(processes, n, metrics, "FCFS");
+                results = cached_output(run_cached(ALG_FCFS, processes, n, 0, &metrics), processes);
+                print_results(results, n, metrics, "FCFS");
+                save_to_file(results, n, metrics, "FCFS");
                 break;
 
             case 4:
@@ -105,9 +859,9 @@ int main() {
                     printf("⚠ No processes loaded! Please add processes first.\n");
                     break;
                 }
-                sjf(processes, n, &metrics);
-                print_results(processes, n, metrics, "SJF");
-                save_to_file(processes, n, metrics, "SJF");
+                results = cached_output(run_cached(ALG_SJF, processes, n, 0, &metrics), processes);
+                print_results(results, n, metrics, "SJF");
+                save_to_file(results, n, metrics, "SJF");
                 break;
 
             case 5:
@@ -115,9 +869,9 @@ int main() {
                     printf("⚠ No processes loaded! Please add processes first.\n");
                     break;
                 }
-                priority_scheduling(processes, n, &metrics);
-                print_results(processes, n, metrics, "Priority");
-                save_to_file(processes, n, metrics, "Priority");
+                results = cached_output(run_cached(ALG_PRIORITY, processes, n, 0, &metrics), processes);
+                print_results(results, n, metrics, "Priority");
+                save_to_file(results, n, metrics, "Priority");
                 break;
 
             case 6:
@@ -127,9 +881,9 @@ int main() {
                 }
                 printf("Enter time quantum: ");
                 scanf("%d", &quantum);
-                round_robin(processes, n, quantum, &metrics);
-                print_results(processes, n, metrics, "Round Robin");
-                save_to_file(processes, n, metrics, "Round Robin");
+                results = cached_output(run_cached(ALG_RR, processes, n, quantum, &metrics), processes);
+                print_results(results, n, metrics, "Round Robin");
+                save_to_file(results, n, metrics, "Round Robin");
                 break;
 
             case 7:
@@ -137,9 +891,9 @@ int main() {
                     printf("⚠ No processes loaded! Please add processes first.\n");
                     break;
                 }
-                srtf(processes, n, &metrics);
-                print_results(processes, n, metrics, "SRTF");
-                save_to_file(processes, n, metrics, "SRTF");
+                results = cached_output(run_cached(ALG_SRTF, processes, n, 0, &metrics), processes);
+                print_results(results, n, metrics, "SRTF");
+                save_to_file(results, n, metrics, "SRTF");
                 break;
 
             case 8:
@@ -147,15 +901,95 @@ int main() {
                     printf("⚠ No processes loaded! Please add processes first.\n");
                     break;
                 }
-                mlfq(processes, n, &metrics);
-                print_results(processes, n, metrics, "MLFQ");
-                save_to_file(processes, n, metrics, "MLFQ");
+                results = cached_output(run_cached(ALG_MLFQ, processes, n, 0, &metrics), processes);
+                print_results(results, n, metrics, "MLFQ");
+                save_to_file(results, n, metrics, "MLFQ");
                 break;
 
             case 9:
                 run_comprehensive_tests();
                 break;
 
+            case 10:
+                resume_from_checkpoint(processes, &n);
+                break;
+
+            case 11:
+                configure_checkpointing();
+                break;
+
+            case 12:
+                generate_advanced_workload(processes, &n);
+                break;
+
+            case 13:
+                load_workload_menu(processes, &n);
+                break;
+
+            case 14:
+                import_trace_menu(processes, &n);
+                break;
+
+            case 15:
+                if (n == 0) {
+                    printf("⚠ No processes loaded! Please add processes first.\n");
+                    break;
+                }
+                printf("Enter aging interval (time units per priority level, 0 = no aging): ");
+                if (scanf("%d", &aging) != 1 || aging < 0) {
+                    printf("⚠ Invalid aging interval!\n");
+                    break;
+                }
+                results = cached_output(priority_preemptive_cached(processes, n, aging, &metrics),
+                                        processes);
+                print_results(results, n, metrics, "Preemptive Priority");
+                save_to_file(results, n, metrics, "Preemptive Priority");
+                break;
+
+            case 16:
+                toggle_monitor();
+                break;
+
+            case 17:
+                if (n == 0) {
+                    printf("⚠ No processes loaded! Please add processes first.\n");
+                    break;
+                }
+                if (!configure_mlq(&mlq_config)) {
+                    break;
+                }
+                results = cached_output(mlq_cached(processes, n, &mlq_config, &metrics,
+                                                  class_metrics, class_counts), processes);
+                print_results(results, n, metrics, "Multilevel Queue");
+                print_class_metrics(stdout, &mlq_config, class_metrics, class_counts);
+                save_to_file(results, n, metrics, "Multilevel Queue");
+                save_class_metrics(&mlq_config, class_metrics, class_counts);
+                break;
+
+            case 18:
+                if (n == 0) {
+                    printf("⚠ No processes loaded! Please add processes first.\n");
+                    break;
+                }
+                heterogeneous_menu(processes, n);
+                break;
+
+            case 19:
+                cache_menu();
+                break;
+
+            case 20:
+                open_system_menu();
+                break;
+
+            case 21:
+                oracle_menu();
+                break;
+
+            case 22:
+                gang_menu(processes, n);
+                break;
+
             case 0:
                 printf("\n✓ Thank you for using OwlTech CPU Scheduler!\n");
                 printf("  Results saved to 'scheduling_results.txt'\n\n");
@@ -190,9 +1024,26 @@ void display_menu() {
     printf("│  New Algorithms:                                           │\n");
     printf("│    7. Shortest Remaining Time First (SRTF) ⭐             │\n");
     printf("│    8. Multi-Level Feedback Queue (MLFQ) ⭐                │\n");
+    printf("│   15. Preemptive Priority with Aging ⭐                   │\n");
+    printf("│   17. Multilevel Queue (per-class policies) ⭐            │\n");
+    printf("│   18. Heterogeneous Cores (big.LITTLE) ⭐                 │\n");
+    printf("│   22. Gang / Batch Scheduling (parallel jobs) ⭐          │\n");
     printf("│                                                            │\n");
     printf("│  Testing:                                                  │\n");
     printf("│    9. Run Comprehensive Tests                              │\n");
+    printf("│   19. Result Cache (stats / clear)                         │\n");
+    printf("│   21. Differential Oracle (fast vs reference engines)      │\n");
+    printf("│                                                            │\n");
+    printf("│  Long Runs:                                                │\n");
+    printf("│   10. Resume From Checkpoint                               │\n");
+    printf("│   11. Configure Checkpointing                              │\n");
+    printf("│   16. Toggle Live Monitor Publishing                       │\n");
+    printf("│   20. Open-System Steady State                             │\n");
+    printf("│                                                            │\n");
+    printf("│  Workload Files:                                           │\n");
+    printf("│   12. Advanced Workload Generator                          │\n");
+    printf("│   13. Load Workload File                                   │\n");
+    printf("│   14. Import Linux Scheduler Trace                         │\n");
     printf("│                                                            │\n");
     printf("│    0. Exit                                                 │\n");
     printf("└────────────────────────────────────────────────────────────┘\n");
@@ -221,6 +1072,13 @@ void input_processes(Process processes[], int *n) {
         printf("Priority (lower number = higher priority): ");
         scanf("%d", &processes[i].priority);
 
+        printf("Class (0 = system, 1 = interactive, 2 = batch): ");
+        scanf("%d", &processes[i].proc_class);
+        if (processes[i].proc_class < 0 || processes[i].proc_class >= NUM_CLASSES) {
+            processes[i].proc_class = classify_process(processes[i].burst_time, processes[i].priority);
+        }
+        processes[i].width = 1;
+
         processes[i].remaining_time = processes[i].burst_time;
         processes[i].waiting_time = 0;
         processes[i].turnaround_time = 0;
@@ -234,8 +1092,6 @@ void input_processes(Process processes[], int *n) {
 }
 
 void generate_test_workload(Process processes[], int *n, int type) {
-    srand(time(NULL));
-
     printf("Enter number of processes to generate (5-100): ");
     scanf("%d", n);
 
@@ -244,7 +1100,14 @@ void generate_test_workload(Process processes[], int *n, int type) {
         *n = 10;
     }
 
-    for (int i = 0; i < *n; i++) {
+    fill_test_workload(processes, *n, type, (unsigned int)time(NULL));
+}
+
+// The same seed always gives the same workload
+void fill_test_workload(Process processes[], int n, int type, unsigned int seed) {
+    srand(seed);
+
+    for (int i = 0; i < n; i++) {
         processes[i].pid = i + 1;
         processes[i].arrival_time = rand() % 20;
 
@@ -266,6 +1129,8 @@ void generate_test_workload(Process processes[], int *n, int type) {
         }
 
         processes[i].priority = 1 + rand() % 10;
+        processes[i].proc_class = classify_process(processes[i].burst_time, processes[i].priority);
+        processes[i].width = 1;
         processes[i].remaining_time = processes[i].burst_time;
         processes[i].waiting_time = 0;
         processes[i].turnaround_time = 0;
@@ -276,401 +1141,4692 @@ void generate_test_workload(Process processes[], int *n, int type) {
     }
 }
 
-void sort_by_arrival(Process processes[], int n) {
-    for (int i = 0; i < n - 1; i++) {
-        for (int j = 0; j < n - i - 1; j++) {
-            if (processes[j].arrival_time > processes[j + 1].arrival_time) {
-                Process temp = processes[j];
-                processes[j] = processes[j + 1];
-                processes[j + 1] = temp;
-            }
-        }
-    }
+// xorshift64* generator: explicit state, so workloads are reproducible from a seed
+uint64_t rng_next(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
 }
 
-void reset_processes(Process original[], Process copy[], int n) {
-    for (int i = 0; i < n; i++) {
-        copy[i] = original[i];
-        copy[i].remaining_time = copy[i].burst_time;
-        copy[i].waiting_time = 0;
-        copy[i].turnaround_time = 0;
-        copy[i].completion_time = 0;
-        copy[i].response_time = -1;
-        copy[i].first_response = false;
-        copy[i].queue_level = 0;
-    }
+// Uniform double in (0, 1), never exactly 0 so log() is always safe
+double rng_uniform(uint64_t *state) {
+    return ((rng_next(state) >> 11) + 0.5) * (1.0 / 9007199254740992.0);
 }
 
-// FCFS Algorithm
-void fcfs(Process processes[], int n, Metrics *metrics) {
-    Process proc[MAX_PROCESSES];
-    reset_processes(processes, proc, n);
-    sort_by_arrival(proc, n);
+double rng_exponential(uint64_t *state, double rate) {
+    return -log(rng_uniform(state)) / rate;
+}
 
-    int current_time = 0;
+double rng_normal(uint64_t *state) {
+    // Box-Muller transform
+    double u1 = rng_uniform(state);
+    double u2 = rng_uniform(state);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * WORKLOAD_PI * u2);
+}
 
-    for (int i = 0; i < n; i++) {
-        if (current_time < proc[i].arrival_time) {
-            current_time = proc[i].arrival_time;
+// The xorshift step is linear over GF(2): column b of the matrix is the
+// image of bit b, and applying it XORs the columns of the set bits
+uint64_t rng_apply(const uint64_t matrix[64], uint64_t x) {
+    uint64_t result = 0;
+    for (int b = 0; x != 0; b++, x >>= 1) {
+        if (x & 1) {
+            result ^= matrix[b];
         }
-
-        proc[i].response_time = current_time - proc[i].arrival_time;
-        current_time += proc[i].burst_time;
-        proc[i].completion_time = current_time;
-        proc[i].turnaround_time = proc[i].completion_time - proc[i].arrival_time;
-        proc[i].waiting_time = proc[i].turnaround_time - proc[i].burst_time;
     }
+    return result;
+}
 
-    calculate_metrics(proc, n, current_time, metrics);
+// Advance the generator by steps draws in O(64^2 log steps) by squaring
+// the step matrix, so any point of a stream can be reached directly
+void rng_jump(uint64_t *state, unsigned long long steps) {
+    uint64_t matrix[64], squared[64];
+    for (int b = 0; b < 64; b++) {
+        uint64_t x = 1ULL << b;
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        matrix[b] = x;
+    }
 
-    for (int i = 0; i < n; i++) {
-        processes[i] = proc[i];
+    uint64_t x = *state;
+    while (steps > 0) {
+        if (steps & 1) {
+            x = rng_apply(matrix, x);
+        }
+        steps >>= 1;
+        if (steps > 0) {
+            for (int b = 0; b < 64; b++) {
+                squared[b] = rng_apply(matrix, matrix[b]);
+            }
+            memcpy(matrix, squared, sizeof(matrix));
+        }
     }
+    *state = x;
 }
 
-// SJF Algorithm
-void sjf(Process processes[], int n, Metrics *metrics) {
-    Process proc[MAX_PROCESSES];
-    reset_processes(processes, proc, n);
+void workload_spec_defaults(WorkloadSpec *spec) {
+    spec->arrival_model = ARRIVAL_POISSON;
+    spec->burst_model = BURST_LOGNORMAL;
+    spec->target_utilization = 0.8;
+    spec->mean_burst = 10.0;
+    spec->pareto_alpha = 1.5;
+    spec->lognormal_sigma = 1.0;
+    spec->bimodal_short = 5.0;
+    spec->bimodal_long = 80.0;
+    spec->bimodal_long_fraction = 0.2;
+    spec->mmpp_rate_ratio = 10.0;
+    spec->mmpp_mean_dwell = 500.0;
+    spec->diurnal_period = 1440.0;
+    spec->diurnal_amplitude = 0.8;
+    spec->seed = 1;
+}
 
-    int current_time = 0, completed = 0;
-    bool visited[MAX_PROCESSES] = {false};
+void workload_init(WorkloadGenerator *gen, const WorkloadSpec *spec) {
+    gen->spec = *spec;
+    gen->rng = spec->seed ? spec->seed : 0x9E3779B97F4A7C15ULL;
+    gen->clock = 0.0;
+    gen->generated = 0;
+
+    // Mean burst actually produced by the burst model
+    if (spec->burst_model == BURST_BIMODAL) {
+        gen->mean_burst = (1.0 - spec->bimodal_long_fraction) * spec->bimodal_short +
+                          spec->bimodal_long_fraction * spec->bimodal_long;
+    } else {
+        gen->mean_burst = spec->mean_burst;
+    }
 
-    while (completed < n) {
-        int idx = -1;
-        int min_burst = 999999;
+    // Offered load on one CPU: utilization = arrival rate * mean burst
+    gen->rate = spec->target_utilization / gen->mean_burst;
 
-        for (int i = 0; i < n; i++) {
-            if (proc[i].arrival_time <= current_time && !visited[i]) {
-                if (proc[i].burst_time < min_burst) {
-                    min_burst = proc[i].burst_time;
-                    idx = i;
+    // MMPP: two states with equal mean dwell, high/low rates averaging to rate
+    gen->mmpp_state = 0;
+    gen->mmpp_low_rate = 2.0 * gen->rate / (1.0 + spec->mmpp_rate_ratio);
+    gen->mmpp_high_rate = gen->mmpp_low_rate * spec->mmpp_rate_ratio;
+    gen->mmpp_switch_time = rng_exponential(&gen->rng, 1.0 / spec->mmpp_mean_dwell);
+}
+
+double workload_next_arrival(WorkloadGenerator *gen) {
+    const WorkloadSpec *spec = &gen->spec;
+
+    switch (spec->arrival_model) {
+        case ARRIVAL_MMPP:
+            // Memoryless: when the state flips before the next arrival,
+            // restart the interarrival draw from the switch point
+            for (;;) {
+                double rate = gen->mmpp_state ? gen->mmpp_high_rate : gen->mmpp_low_rate;
+                double next = gen->clock + rng_exponential(&gen->rng, rate);
+                if (next < gen->mmpp_switch_time) {
+                    gen->clock = next;
+                    break;
                 }
+                gen->clock = gen->mmpp_switch_time;
+                gen->mmpp_state = !gen->mmpp_state;
+                gen->mmpp_switch_time += rng_exponential(&gen->rng, 1.0 / spec->mmpp_mean_dwell);
             }
+            break;
+
+        case ARRIVAL_DIURNAL: {
+            // Non-homogeneous Poisson via thinning against the peak rate
+            double peak = gen->rate * (1.0 + spec->diurnal_amplitude);
+            for (;;) {
+                gen->clock += rng_exponential(&gen->rng, peak);
+                double phase = 2.0 * WORKLOAD_PI * gen->clock / spec->diurnal_period;
+                double rate = gen->rate * (1.0 + spec->diurnal_amplitude * sin(phase));
+                if (rng_uniform(&gen->rng) * peak <= rate) {
+                    break;
+                }
+            }
+            break;
         }
 
-        if (idx != -1) {
-            proc[idx].response_time = current_time - proc[idx].arrival_time;
-            current_time += proc[idx].burst_time;
-            proc[idx].completion_time = current_time;
-            proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
-            proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
-            visited[idx] = true;
-            completed++;
-        } else {
-            current_time++;
+        case ARRIVAL_POISSON:
+        default:
+            gen->clock += rng_exponential(&gen->rng, gen->rate);
+            break;
+    }
+
+    return gen->clock;
+}
+
+int workload_next_burst(WorkloadGenerator *gen) {
+    const WorkloadSpec *spec = &gen->spec;
+    double burst;
+
+    switch (spec->burst_model) {
+        case BURST_PARETO: {
+            // Scale chosen so the mean equals mean_burst (requires alpha > 1)
+            double xm = spec->mean_burst * (spec->pareto_alpha - 1.0) / spec->pareto_alpha;
+            burst = xm / pow(rng_uniform(&gen->rng), 1.0 / spec->pareto_alpha);
+            break;
+        }
+        case BURST_BIMODAL: {
+            double mode = (rng_uniform(&gen->rng) < spec->bimodal_long_fraction)
+                              ? spec->bimodal_long : spec->bimodal_short;
+            burst = rng_exponential(&gen->rng, 1.0 / mode);
+            break;
+        }
+        case BURST_LOGNORMAL:
+        default: {
+            double sigma = spec->lognormal_sigma;
+            double mu = log(spec->mean_burst) - sigma * sigma / 2.0;
+            burst = exp(mu + sigma * rng_normal(&gen->rng));
+            break;
         }
     }
 
-    calculate_metrics(proc, n, current_time, metrics);
+    if (burst < 1.0) {
+        return 1;
+    }
+    if (burst > MAX_GENERATED_BURST) {
+        return MAX_GENERATED_BURST;
+    }
+    return (int)(burst + 0.5);
+}
 
-    for (int i = 0; i < n; i++) {
-        processes[i] = proc[i];
+// Generator draws per Poisson process: arrival, burst, priority
+int workload_draws(const WorkloadSpec *spec) {
+    int burst_draws = spec->burst_model == BURST_PARETO ? 1 : 2;
+    return 1 + burst_draws + 1;
+}
+
+// Processes [first, first + count) of a Poisson stream, on their own: the
+// generator jumps straight to the chunk's first draw and arrivals are
+// offset plus the chunk's running sum. With out == NULL only that sum is
+// computed (bursts are skipped, not sampled). Returns the sum.
+double workload_chunk(const WorkloadGenerator *base, long long first, long long count,
+                      double offset, char *out, char **end) {
+    WorkloadGenerator gen = *base;
+    int draws = workload_draws(&gen.spec);
+    rng_jump(&gen.rng, (unsigned long long)first * draws);
+    gen.clock = 0.0;
+
+    for (long long i = 0; i < count; i++) {
+        if (out == NULL) {
+            gen.clock += rng_exponential(&gen.rng, gen.rate);
+            for (int d = 1; d < draws; d++) {
+                rng_next(&gen.rng);
+            }
+            continue;
+        }
+        double arrival = offset + workload_next_arrival(&gen);
+        int burst = workload_next_burst(&gen);
+        int priority = 1 + (int)(rng_next(&gen.rng) % 10);
+        out = workload_format_line(out, (long long)arrival, burst, priority,
+                                   classify_process(burst, priority));
+    }
+
+    if (end != NULL) {
+        *end = out;
     }
+    return gen.clock;
 }
 
-// Priority Scheduling
-void priority_scheduling(Process processes[], int n, Metrics *metrics) {
-    Process proc[MAX_PROCESSES];
-    reset_processes(processes, proc, n);
+void workload_next(WorkloadGenerator *gen, Process *p) {
+    double arrival = workload_next_arrival(gen);
+
+    gen->generated++;
+    p->pid = (int)(gen->generated % INT_MAX);
+    p->arrival_time = (arrival < INT_MAX) ? (int)arrival : INT_MAX;
+    p->burst_time = workload_next_burst(gen);
+    p->priority = 1 + (int)(rng_next(&gen->rng) % 10);
+    p->proc_class = classify_process(p->burst_time, p->priority);
+    p->width = 1;
+    p->remaining_time = p->burst_time;
+    p->waiting_time = 0;
+    p->turnaround_time = 0;
+    p->completion_time = 0;
+    p->response_time = -1;
+    p->first_response = false;
+    p->queue_level = 0;
+}
 
-    int current_time = 0, completed = 0;
-    bool visited[MAX_PROCESSES] = {false};
+// Append the decimal form of v to out, returning the new end
+char *append_number(char *out, long long v) {
+    char digits[24];
+    int len = 0;
+    unsigned long long u = (v < 0) ? (unsigned long long)(-(v + 1)) + 1 : (unsigned long long)v;
 
-    while (completed < n) {
-        int idx = -1;
-        int highest_priority = 999999;
+    if (v < 0) {
+        *out++ = '-';
+    }
+    do {
+        digits[len++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u > 0);
+    while (len > 0) {
+        *out++ = digits[--len];
+    }
+    return out;
+}
 
-        for (int i = 0; i < n; i++) {
-            if (proc[i].arrival_time <= current_time && !visited[i]) {
-                if (proc[i].priority < highest_priority) {
-                    highest_priority = proc[i].priority;
-                    idx = i;
-                }
-            }
-        }
+bool workload_writer_open(WorkloadWriter *w, const char *filename) {
+    w->fp = fopen(filename, "w");
+    if (w->fp == NULL) {
+        return false;
+    }
+    w->buffer = malloc(WORKLOAD_WRITE_BUFFER);
+    if (w->buffer == NULL) {
+        fclose(w->fp);
+        return false;
+    }
+    w->out = w->buffer;
+    w->written = 0;
+    w->failed = false;
 
-        if (idx != -1) {
-            proc[idx].response_time = current_time - proc[idx].arrival_time;
-            current_time += proc[idx].burst_time;
-            proc[idx].completion_time = current_time;
-            proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
-            proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
-            visited[idx] = true;
-            completed++;
-        } else {
-            current_time++;
+    fprintf(w->fp, "# arrival burst priority class\n");
+    return true;
+}
+
+// Lines are formatted by hand into a large buffer, which is much faster
+// than one fprintf() per field at tens of millions of lines
+char *workload_format_line(char *out, long long arrival, int burst, int priority, int proc_class) {
+    out = append_number(out, arrival);
+    *out++ = ' ';
+    out = append_number(out, burst);
+    *out++ = ' ';
+    out = append_number(out, priority);
+    *out++ = ' ';
+    out = append_number(out, proc_class);
+    *out++ = '\n';
+    return out;
+}
+
+void workload_writer_put(WorkloadWriter *w, long long arrival, int burst, int priority, int proc_class) {
+    char *out = workload_format_line(w->out, arrival, burst, priority, proc_class);
+    w->out = out;
+    w->written++;
+
+    if (out >= w->buffer + WORKLOAD_WRITE_BUFFER - 80) {
+        size_t len = out - w->buffer;
+        if (fwrite(w->buffer, 1, len, w->fp) != len) {
+            w->failed = true;
         }
+        w->out = w->buffer;
     }
+}
 
-    calculate_metrics(proc, n, current_time, metrics);
+// Write already formatted lines after whatever is buffered
+void workload_writer_append(WorkloadWriter *w, const char *data, size_t len, long long lines) {
+    size_t buffered = w->out - w->buffer;
+    if (buffered > 0 && fwrite(w->buffer, 1, buffered, w->fp) != buffered) {
+        w->failed = true;
+    }
+    w->out = w->buffer;
+    if (len > 0 && fwrite(data, 1, len, w->fp) != len) {
+        w->failed = true;
+    }
+    w->written += lines;
+}
 
-    for (int i = 0; i < n; i++) {
-        processes[i] = proc[i];
+bool workload_writer_close(WorkloadWriter *w) {
+    size_t len = w->out - w->buffer;
+    if (len > 0 && fwrite(w->buffer, 1, len, w->fp) != len) {
+        w->failed = true;
+    }
+    if (fclose(w->fp) != 0) {
+        w->failed = true;
     }
+    free(w->buffer);
+    return !w->failed;
 }
 
-// Round Robin Algorithm
-void round_robin(Process processes[], int n, int quantum, Metrics *metrics) {
-    Process proc[MAX_PROCESSES];
-    reset_processes(processes, proc, n);
+// Stream count processes straight to a workload file without holding them.
+// Poisson arrivals are generated in fixed chunks (in parallel with workers
+// > 1, 0 = one per core); the output depends only on the spec, never on
+// the worker count. MMPP and diurnal arrivals depend on the modulating
+// state and absolute time, so they stay sequential.
+long long stream_workload_file(const char *filename, const WorkloadSpec *spec, long long count,
+                               int workers) {
+    WorkloadWriter writer;
+    if (!workload_writer_open(&writer, filename)) {
+        return -1;
+    }
 
-    int current_time = 0, completed = 0;
-    int queue[MAX_PROCESSES * 10];
-    int front = 0, rear = 0;
-    bool in_queue[MAX_PROCESSES] = {false};
+    WorkloadGenerator gen;
+    workload_init(&gen, spec);
 
-    // Add first arriving process
-    int min_arrival = 999999;
-    int first_idx = 0;
-    for (int i = 0; i < n; i++) {
-        if (proc[i].arrival_time < min_arrival) {
-            min_arrival = proc[i].arrival_time;
-            first_idx = i;
+    if (spec->arrival_model == ARRIVAL_POISSON) {
+        if (!stream_chunks_parallel(&writer, &gen, count, workers) &&
+            !stream_chunks(&writer, &gen, count)) {
+            writer.failed = true;
+        }
+    } else {
+        for (long long i = 0; i < count; i++) {
+            double arrival = workload_next_arrival(&gen);
+            int burst = workload_next_burst(&gen);
+            int priority = 1 + (int)(rng_next(&gen.rng) % 10);
+            workload_writer_put(&writer, (long long)arrival, burst, priority,
+                                classify_process(burst, priority));
         }
     }
 
-    current_time = proc[first_idx].arrival_time;
-    queue[rear++] = first_idx;
-    in_queue[first_idx] = true;
+    if (!workload_writer_close(&writer)) {
+        return -1;
+    }
+    return writer.written;
+}
 
-    while (completed < n) {
-        if (front == rear) {
-            // Queue empty, find next arriving process
-            int next_arrival = 999999;
-            int next_idx = -1;
-            for (int i = 0; i < n; i++) {
-                if (proc[i].remaining_time > 0 && proc[i].arrival_time > current_time) {
+// Poisson chunks one after another, carrying the arrival offset
+bool stream_chunks(WorkloadWriter *writer, const WorkloadGenerator *base, long long count) {
+    char *buffer = malloc((size_t)WORKLOAD_CHUNK * WORKLOAD_LINE_MAX);
+    if (buffer == NULL) {
+        return false;
+    }
+
+    double offset = 0.0;
+    for (long long first = 0; first < count; first += WORKLOAD_CHUNK) {
+        long long len = count - first < WORKLOAD_CHUNK ? count - first : WORKLOAD_CHUNK;
+        char *end;
+        offset += workload_chunk(base, first, len, offset, buffer, &end);
+        workload_writer_append(writer, buffer, end - buffer, len);
+    }
+    free(buffer);
+    return true;
+}
+
+#ifdef PARALLEL_SUPPORTED
+// One byte from each of count workers (false if one died)
+bool workers_wait(int fd, int count) {
+    for (int k = 0; k < count; k++) {
+        char byte;
+        if (read(fd, &byte, 1) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Start the next round on every worker
+bool workers_release(const int go[], int count) {
+    for (int w = 0; w < count; w++) {
+        char byte = 1;
+        if (write(go[w], &byte, 1) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
+// Poisson chunks across forked workers, in two passes: each worker sums
+// the interarrival times of its chunks, the prefix sums of those give
+// every chunk's arrival offset, then workers format chunks into shared
+// memory round by round. Rounds alternate between two slot sets so the
+// parent writes one round while the workers fill the next. Returns false
+// (nothing written) when it cannot run in parallel.
+bool stream_chunks_parallel(WorkloadWriter *writer, const WorkloadGenerator *base,
+                            long long count, int workers) {
+#ifdef PARALLEL_SUPPORTED
+    long long chunks = (count + WORKLOAD_CHUNK - 1) / WORKLOAD_CHUNK;
+    if (workers <= 0) {
+        workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (workers > MAX_WORKLOAD_WORKERS) {
+        workers = MAX_WORKLOAD_WORKERS;
+    }
+    if ((long long)workers > chunks) {
+        workers = (int)chunks;
+    }
+    if (workers < 2) {
+        return false;
+    }
+
+    // Shared memory: offsets[chunks], lengths[2][workers], slots[2][workers]
+    size_t slot_size = (size_t)WORKLOAD_CHUNK * WORKLOAD_LINE_MAX;
+    size_t header = sizeof(double) * chunks + sizeof(long long) * 2 * workers;
+    header = (header + 63) & ~(size_t)63;
+    size_t total = header + slot_size * 2 * workers;
+
+    char name[64];
+    snprintf(name, sizeof(name), "/cpu_scheduler_gen_%ld", (long)getpid());
+    int shm = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (shm < 0) {
+        return false;
+    }
+    shm_unlink(name);
+    void *shared = MAP_FAILED;
+    if (ftruncate(shm, (off_t)total) == 0) {
+        shared = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, shm, 0);
+    }
+    close(shm);
+    if (shared == MAP_FAILED) {
+        return false;
+    }
+    double *offsets = shared;
+    long long *lengths = (long long *)(offsets + chunks);
+    char *slots = (char *)shared + header;
+
+    int done[2];
+    if (pipe(done) != 0) {
+        munmap(shared, total);
+        return false;
+    }
+
+    int go[MAX_WORKLOAD_WORKERS];
+    pid_t pids[MAX_WORKLOAD_WORKERS];
+    int started = 0;
+    for (int w = 0; w < workers; w++) {
+        int pipefd[2];
+        if (pipe(pipefd) != 0) {
+            break;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(pipefd[0]);
+            close(pipefd[1]);
+            break;
+        }
+        if (pid == 0) {
+            close(pipefd[1]);
+            close(done[0]);
+            char byte = 1;
+
+            // Pass 1: interarrival sums of this worker's chunks
+            for (long long c = w; c < chunks; c += workers) {
+                long long first = c * WORKLOAD_CHUNK;
+                long long len = count - first < WORKLOAD_CHUNK ? count - first : WORKLOAD_CHUNK;
+                offsets[c] = workload_chunk(base, first, len, 0.0, NULL, NULL);
+            }
+            if (write(done[1], &byte, 1) != 1) {
+                _exit(1);
+            }
+
+            // Pass 2: one chunk per round, until the parent closes the pipe
+            for (long long round = 0; read(pipefd[0], &byte, 1) == 1; round++) {
+                long long c = round * workers + w;
+                int set = (int)(round % 2);
+                char *slot = slots + slot_size * ((size_t)set * workers + w);
+                char *end = slot;
+                if (c < chunks) {
+                    long long first = c * WORKLOAD_CHUNK;
+                    long long len = count - first < WORKLOAD_CHUNK ? count - first : WORKLOAD_CHUNK;
+                    workload_chunk(base, first, len, offsets[c], slot, &end);
+                }
+                lengths[set * workers + w] = end - slot;
+                if (write(done[1], &byte, 1) != 1) {
+                    _exit(1);
+                }
+            }
+            _exit(0);
+        }
+        close(pipefd[0]);
+        go[started] = pipefd[1];
+        pids[started] = pid;
+        started++;
+    }
+    close(done[1]);
+
+    bool ok = started == workers && workers_wait(done[0], started);
+    if (ok) {
+        // Sums become exclusive prefix sums, in chunk order
+        double offset = 0.0;
+        for (long long c = 0; c < chunks; c++) {
+            double sum = offsets[c];
+            offsets[c] = offset;
+            offset += sum;
+        }
+    }
+
+    long long rounds = (chunks + workers - 1) / workers;
+    ok = ok && workers_release(go, workers);
+    for (long long round = 0; ok && round < rounds; round++) {
+        ok = workers_wait(done[0], workers);
+        if (ok && round + 1 < rounds) {
+            ok = workers_release(go, workers);
+        }
+        int set = (int)(round % 2);
+        for (int w = 0; ok && w < workers; w++) {
+            long long c = round * workers + w;
+            if (c < chunks) {
+                long long first = c * WORKLOAD_CHUNK;
+                long long len = count - first < WORKLOAD_CHUNK ? count - first : WORKLOAD_CHUNK;
+                workload_writer_append(writer, slots + slot_size * ((size_t)set * workers + w),
+                                       (size_t)lengths[set * workers + w], len);
+            }
+        }
+    }
+    for (int w = 0; w < started; w++) {
+        close(go[w]);
+    }
+    close(done[0]);
+    for (int w = 0; w < started; w++) {
+        waitpid(pids[w], NULL, 0);
+    }
+    munmap(shared, total);
+
+    if (!ok && writer->written > 0) {
+        // Died part way: the file is incomplete
+        writer->failed = true;
+        return true;
+    }
+    return ok;
+#else
+    (void)writer;
+    (void)base;
+    (void)count;
+    (void)workers;
+    return false;
+#endif
+}
+
+// Parse one workload line ("arrival burst priority [class] [width]").
+// Without a class column the class is derived from the process. Returns
+// false for comments, blank and invalid lines; the pid is left to the caller.
+bool parse_workload_line(const char *line, Process *p) {
+    if (line[0] == '#' || line[0] == '\n') {
+        return false;
+    }
+
+    long long arrival;
+    int burst, priority, proc_class, width;
+    int fields = sscanf(line, "%lld %d %d %d %d", &arrival, &burst, &priority, &proc_class, &width);
+    if (fields < 3 || arrival < 0 || arrival > INT_MAX || burst <= 0) {
+        return false;
+    }
+    if (fields < 4 || proc_class < 0 || proc_class >= NUM_CLASSES) {
+        proc_class = classify_process(burst, priority);
+    }
+    if (fields < 5 || width < 1) {
+        width = 1;
+    }
+
+    p->arrival_time = (int)arrival;
+    p->burst_time = burst;
+    p->priority = priority;
+    p->proc_class = proc_class;
+    p->width = width;
+    p->remaining_time = burst;
+    p->waiting_time = 0;
+    p->turnaround_time = 0;
+    p->completion_time = 0;
+    p->response_time = -1;
+    p->first_response = false;
+    p->queue_level = 0;
+    return true;
+}
+
+// Load a workload file ('#' comments). Only the first MAX_PROCESSES
+// entries fit in the simulator.
+bool load_workload_file(const char *filename, Process processes[], int *n) {
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        return false;
+    }
+
+    char line[256];
+    bool truncated = false;
+    Process p;
+    *n = 0;
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (!parse_workload_line(line, &p)) {
+            continue;
+        }
+        if (*n >= MAX_PROCESSES) {
+            // No need to read millions more lines just to count them
+            truncated = true;
+            break;
+        }
+        p.pid = *n + 1;
+        processes[(*n)++] = p;
+    }
+    fclose(fp);
+
+    if (truncated) {
+        printf("⚠ Workload truncated to the first %d processes (file has more)\n", MAX_PROCESSES);
+    }
+    return *n > 0;
+}
+
+int compare_arrival_pid(const void *a, const void *b) {
+    const Process *x = a, *y = b;
+    if (x->arrival_time != y->arrival_time) {
+        return x->arrival_time < y->arrival_time ? -1 : 1;
+    }
+    return (x->pid > y->pid) - (x->pid < y->pid);
+}
+
+// Load the MAX_PROCESSES earliest arrivals of a file that is not in
+// arrival order (imported traces are written in completion order). Ties
+// go to the earlier line.
+bool load_earliest_arrivals(const char *filename, Process processes[], int *n) {
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        return false;
+    }
+
+    char line[256];
+    long long total = 0;
+    int latest = 0;   // Kept entry with the latest arrival, once full
+    Process p;
+    *n = 0;
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (!parse_workload_line(line, &p)) {
+            continue;
+        }
+        p.pid = (int)(total < INT_MAX ? total : INT_MAX);   // Line order, for ties
+        total++;
+        if (*n < MAX_PROCESSES) {
+            processes[(*n)++] = p;
+        } else if (p.arrival_time < processes[latest].arrival_time) {
+            processes[latest] = p;
+        } else {
+            continue;
+        }
+        if (*n == MAX_PROCESSES) {
+            for (int i = 0; i < *n; i++) {
+                if (compare_arrival_pid(&processes[i], &processes[latest]) > 0) {
+                    latest = i;
+                }
+            }
+        }
+    }
+    fclose(fp);
+
+    qsort(processes, *n, sizeof(Process), compare_arrival_pid);
+    for (int i = 0; i < *n; i++) {
+        processes[i].pid = i + 1;
+    }
+    if (total > *n) {
+        printf("⚠ Workload truncated to the %d earliest arrivals (%lld in file)\n", MAX_PROCESSES, total);
+    }
+    return *n > 0;
+}
+
+// Prompt for generator models, load and seed (shared by the generator
+// and the open-system simulation)
+bool read_workload_spec(WorkloadSpec *spec) {
+    workload_spec_defaults(spec);
+
+    printf("\nArrival process:\n");
+    printf("1. Poisson\n");
+    printf("2. Bursty (2-state MMPP)\n");
+    printf("3. Diurnal load curve\n");
+    printf("Choice: ");
+    if (scanf("%d", &spec->arrival_model) != 1 ||
+        spec->arrival_model < ARRIVAL_POISSON || spec->arrival_model > ARRIVAL_DIURNAL) {
+        printf("⚠ Invalid choice!\n");
+        return false;
+    }
+
+    printf("\nBurst size distribution:\n");
+    printf("1. Pareto (heavy-tailed, alpha = %.1f)\n", spec->pareto_alpha);
+    printf("2. Lognormal (sigma = %.1f)\n", spec->lognormal_sigma);
+    printf("3. Bimodal (%.0f / %.0f, %.0f%% long)\n",
+           spec->bimodal_short, spec->bimodal_long, spec->bimodal_long_fraction * 100.0);
+    printf("Choice: ");
+    if (scanf("%d", &spec->burst_model) != 1 ||
+        spec->burst_model < BURST_PARETO || spec->burst_model > BURST_BIMODAL) {
+        printf("⚠ Invalid choice!\n");
+        return false;
+    }
+
+    if (spec->burst_model != BURST_BIMODAL) {
+        printf("Mean burst time: ");
+        if (scanf("%lf", &spec->mean_burst) != 1 || spec->mean_burst < 1.0) {
+            printf("⚠ Invalid mean burst!\n");
+            return false;
+        }
+    }
+
+    printf("Target CPU utilization (0.01-1.5): ");
+    if (scanf("%lf", &spec->target_utilization) != 1 ||
+        spec->target_utilization < 0.01 || spec->target_utilization > 1.5) {
+        printf("⚠ Invalid utilization!\n");
+        return false;
+    }
+
+    printf("Random seed: ");
+    unsigned long long seed;
+    if (scanf("%llu", &seed) != 1) {
+        printf("⚠ Invalid seed!\n");
+        return false;
+    }
+    spec->seed = seed;
+    return true;
+}
+
+void generate_advanced_workload(Process processes[], int *n) {
+    WorkloadSpec spec;
+    if (!read_workload_spec(&spec)) {
+        return;
+    }
+
+    printf("\nOutput:\n");
+    printf("1. Load into simulator (up to %d processes)\n", MAX_PROCESSES);
+    printf("2. Stream to workload file\n");
+    printf("Choice: ");
+    int output;
+    if (scanf("%d", &output) != 1) {
+        return;
+    }
+
+    if (output == 1) {
+        printf("Number of processes (1-%d): ", MAX_PROCESSES);
+        if (scanf("%d", n) != 1 || *n <= 0 || *n > MAX_PROCESSES) {
+            printf("⚠ Invalid number of processes!\n");
+            *n = 0;
+            return;
+        }
+
+        WorkloadGenerator gen;
+        workload_init(&gen, &spec);
+        for (int i = 0; i < *n; i++) {
+            workload_next(&gen, &processes[i]);
+        }
+        printf("✓ Generated %d processes\n", *n);
+    } else if (output == 2) {
+        char filename[256];
+        long long count;
+        printf("Output file: ");
+        if (scanf("%255s", filename) != 1) {
+            return;
+        }
+        printf("Number of processes: ");
+        if (scanf("%lld", &count) != 1 || count <= 0) {
+            printf("⚠ Invalid number of processes!\n");
+            return;
+        }
+        int workers = 1;
+        if (spec.arrival_model == ARRIVAL_POISSON) {
+            printf("Worker processes (0 = one per core): ");
+            if (scanf("%d", &workers) != 1 || workers < 0) {
+                printf("⚠ Invalid number of workers!\n");
+                return;
+            }
+        }
+
+        double start = monotonic_seconds();
+        long long written = stream_workload_file(filename, &spec, count, workers);
+        double seconds = monotonic_seconds() - start;
+        if (written < 0) {
+            printf("⚠ Error writing '%s'!\n", filename);
+            return;
+        }
+        printf("✓ Wrote %lld processes to '%s'", written, filename);
+        if (seconds > 0) {
+            printf(" (%.1f M processes/sec)", written / seconds / 1e6);
+        }
+        printf("\n");
+    } else {
+        printf("⚠ Invalid choice!\n");
+    }
+}
+
+void load_workload_menu(Process processes[], int *n) {
+    char filename[256];
+    printf("Workload file: ");
+    if (scanf("%255s", filename) != 1) {
+        return;
+    }
+
+    if (!load_workload_file(filename, processes, n)) {
+        printf("⚠ Could not load any processes from '%s'!\n", filename);
+        *n = 0;
+        return;
+    }
+    printf("✓ Loaded %d processes\n", *n);
+}
+
+// Find "key=" in s where the key starts a whitespace-separated field, so
+// that looking up "pid=" does not match inside "prev_pid="
+const char *trace_field(const char *s, const char *key) {
+    size_t len = strlen(key);
+    const char *p = s;
+
+    while ((p = strstr(p, key)) != NULL) {
+        if (p == s || p[-1] == ' ' || p[-1] == '\t') {
+            return p + len;
+        }
+        p += len;
+    }
+    return NULL;
+}
+
+// Parse "comm:pid [prio]" as printed by perf sched script. The comm may
+// itself contain ':' and spaces, so the pid is read backwards from the
+// '['. Returns the text after ']', or NULL.
+const char *trace_task_ref(const char *s, int *pid, int *prio) {
+    const char *bracket = strchr(s, '[');
+    if (bracket == NULL) {
+        return NULL;
+    }
+    const char *p = bracket;
+    while (p > s && p[-1] == ' ') {
+        p--;
+    }
+    const char *digits_end = p;
+    while (p > s && p[-1] >= '0' && p[-1] <= '9') {
+        p--;
+    }
+    if (p == digits_end || p == s || p[-1] != ':') {
+        return NULL;
+    }
+    *pid = atoi(p);
+
+    char *after;
+    long value = strtol(bracket + 1, &after, 10);
+    if (after == bracket + 1 || *after != ']') {
+        return NULL;
+    }
+    *prio = (int)value;
+    return after + 1;
+}
+
+// Timestamp is the "<seconds>:" token just before the event name, in both
+// the perf sched script and the ftrace text formats
+bool trace_timestamp(const char *line, const char *event, double *ts) {
+    const char *p = event;
+    while (p > line && p[-1] != ' ' && p[-1] != '\t') {
+        p--;   // Start of the event token (may carry a "sched:" prefix)
+    }
+    while (p > line && (p[-1] == ' ' || p[-1] == '\t')) {
+        p--;
+    }
+    const char *end = p;
+    if (end == line || end[-1] != ':') {
+        return false;
+    }
+    while (p > line && p[-1] != ' ' && p[-1] != '\t') {
+        p--;
+    }
+
+    char *parsed;
+    *ts = strtod(p, &parsed);
+    return parsed == end - 1;
+}
+
+unsigned int trace_slot(int pid) {
+    return ((unsigned int)pid * 2654435761u) & (TRACE_TASK_SLOTS - 1);
+}
+
+// Open-addressing lookup; returns NULL when a new task does not fit
+TraceTask *trace_task(TraceImport *imp, int pid, bool create) {
+    unsigned int h = trace_slot(pid);
+
+    for (int probe = 0; probe < TRACE_TASK_SLOTS; probe++) {
+        TraceTask *t = &imp->tasks[h];
+        if (t->used && t->pid == pid) {
+            return t;
+        }
+        if (!t->used) {
+            if (!create || imp->task_count >= TRACE_TASK_SLOTS * 3 / 4) {
+                return NULL;
+            }
+            t->used = true;
+            t->pid = pid;
+            t->in_job = false;
+            t->running = false;
+            imp->task_count++;
+            if (imp->task_count > imp->peak_tasks) {
+                imp->peak_tasks = imp->task_count;
+            }
+            return t;
+        }
+        h = (h + 1) & (TRACE_TASK_SLOTS - 1);
+    }
+    return NULL;
+}
+
+// Free a task's slot once it has no job in progress, so the table only
+// holds live jobs however many PIDs a long trace goes through. Linear
+// probing: later entries of the same probe run shift back into the hole
+// instead of leaving a tombstone.
+void trace_task_remove(TraceImport *imp, TraceTask *t) {
+    unsigned int hole = (unsigned int)(t - imp->tasks);
+    unsigned int i = hole;
+
+    for (;;) {
+        i = (i + 1) & (TRACE_TASK_SLOTS - 1);
+        TraceTask *next = &imp->tasks[i];
+        if (!next->used) {
+            break;
+        }
+        // Movable when its home slot is not cyclically inside (hole, i]
+        unsigned int home = trace_slot(next->pid);
+        if (((i - home) & (TRACE_TASK_SLOTS - 1)) >= ((i - hole) & (TRACE_TASK_SLOTS - 1))) {
+            imp->tasks[hole] = *next;
+            hole = i;
+        }
+    }
+    imp->tasks[hole].used = false;
+    imp->task_count--;
+}
+
+// Kernel prio 0-99 is real-time, 100-139 maps nice -20..19 onto 1..10
+int trace_priority(int prio) {
+    if (prio < 100) {
+        return 1;
+    }
+    if (prio > 139) {
+        prio = 139;
+    }
+    return 1 + (prio - 100) * 9 / 39;
+}
+
+// Real-time tasks are system work, raised-priority (negative nice) tasks
+// interactive, everything else batch
+int trace_class(int prio) {
+    if (prio < 100) {
+        return CLASS_SYSTEM;
+    }
+    return prio < 120 ? CLASS_INTERACTIVE : CLASS_BATCH;
+}
+
+void trace_start_job(TraceImport *imp, TraceTask *t, double ts, int prio) {
+    t->in_job = true;
+    t->arrival = ts - imp->first_ts;
+    t->run = 0.0;
+    t->prio = prio;
+}
+
+void trace_emit_job(TraceImport *imp, TraceTask *t) {
+    long long arrival = (long long)(t->arrival / imp->time_unit);
+    long long burst = (long long)(t->run / imp->time_unit + 0.5);
+    if (burst < 1) {
+        burst = 1;
+    }
+    if (burst > INT_MAX) {
+        burst = INT_MAX;
+    }
+    workload_writer_put(&imp->writer, arrival, (int)burst, trace_priority(t->prio),
+                        trace_class(t->prio));
+    t->in_job = false;
+}
+
+void trace_handle_line(TraceImport *imp, const char *line) {
+    const char *ev;
+    double ts;
+
+    if ((ev = strstr(line, "sched_switch:")) != NULL) {
+        if (!trace_timestamp(line, ev, &ts)) {
+            return;
+        }
+        if (!imp->have_first_ts) {
+            imp->first_ts = ts;
+            imp->have_first_ts = true;
+        }
+        imp->last_ts = ts;
+        imp->events++;
+
+        // Either key=value fields (ftrace, raw tracepoint format) or perf's
+        // "prev:pid [prio] S ==> next:pid [prio]"
+        int prev_pid, prev_prio = -1, next_pid, next_prio = 120;
+        bool runnable;
+        const char *field = trace_field(ev, "prev_pid=");
+        const char *arrow = strstr(ev, "==>");
+        if (field != NULL) {
+            const char *next_field = trace_field(ev, "next_pid=");
+            const char *state = trace_field(ev, "prev_state=");
+            if (next_field == NULL) {
+                imp->malformed++;
+                return;
+            }
+            prev_pid = atoi(field);
+            next_pid = atoi(next_field);
+            runnable = state != NULL && state[0] == 'R';
+            if ((field = trace_field(ev, "prev_prio=")) != NULL) {
+                prev_prio = atoi(field);
+            }
+            if ((field = trace_field(ev, "next_prio=")) != NULL) {
+                next_prio = atoi(field);
+            }
+        } else {
+            const char *state = arrow ? trace_task_ref(ev + strlen("sched_switch:"), &prev_pid, &prev_prio) : NULL;
+            if (state == NULL || trace_task_ref(arrow + 3, &next_pid, &next_prio) == NULL) {
+                imp->malformed++;
+                return;
+            }
+            while (*state == ' ') {
+                state++;
+            }
+            runnable = state[0] == 'R';
+        }
+
+        // Task leaving the CPU: accumulate its run; it keeps its job only
+        // when preempted while still runnable (state R / R+)
+        if (prev_pid != 0) {
+            TraceTask *t = trace_task(imp, prev_pid, false);
+            if (t != NULL && t->running) {
+                t->run += ts - t->running_since;
+                t->running = false;
+                if (t->in_job && !runnable) {
+                    if (prev_prio >= 0) {
+                        t->prio = prev_prio;
+                    }
+                    trace_emit_job(imp, t);
+                    trace_task_remove(imp, t);
+                }
+            }
+        }
+
+        // Task entering the CPU: tasks already runnable when the trace
+        // started have no wakeup, so their job begins here
+        if (next_pid != 0) {
+            TraceTask *t = trace_task(imp, next_pid, true);
+            if (t == NULL) {
+                imp->dropped++;
+                return;
+            }
+            if (!t->in_job) {
+                trace_start_job(imp, t, ts, next_prio);
+            }
+            t->running = true;
+            t->running_since = ts;
+        }
+    } else if ((ev = strstr(line, "sched_wakeup")) != NULL) {
+        // Covers sched_wakeup: and sched_wakeup_new:
+        const char *colon = strchr(ev, ':');
+        if (colon == NULL || !trace_timestamp(line, ev, &ts)) {
+            return;
+        }
+        if (!imp->have_first_ts) {
+            imp->first_ts = ts;
+            imp->have_first_ts = true;
+        }
+        imp->last_ts = ts;
+        imp->events++;
+
+        // "pid=N prio=P" fields, or perf's "comm:pid [prio]"
+        int pid, prio = 120;
+        const char *pid_field = trace_field(colon, "pid=");
+        if (pid_field != NULL) {
+            const char *prio_field = trace_field(colon, "prio=");
+            pid = atoi(pid_field);
+            if (prio_field != NULL) {
+                prio = atoi(prio_field);
+            }
+        } else if (trace_task_ref(colon + 1, &pid, &prio) == NULL) {
+            imp->malformed++;
+            return;
+        }
+
+        if (pid == 0) {
+            return;
+        }
+        TraceTask *t = trace_task(imp, pid, true);
+        if (t == NULL) {
+            imp->dropped++;
+            return;
+        }
+        if (!t->in_job) {
+            trace_start_job(imp, t, ts, prio);
+        }
+    }
+}
+
+// Convert a perf sched / ftrace text dump into a workload file in one
+// streaming pass. Memory is bounded by the task table, not the trace size.
+bool import_sched_trace(const char *trace_file, const char *workload_file,
+                        double time_unit_us, TraceImport *imp) {
+    FILE *fp = fopen(trace_file, "r");
+    if (fp == NULL) {
+        return false;
+    }
+
+    memset(imp, 0, sizeof(*imp));
+    imp->time_unit = time_unit_us / 1e6;
+    imp->tasks = calloc(TRACE_TASK_SLOTS, sizeof(TraceTask));
+    if (imp->tasks == NULL || !workload_writer_open(&imp->writer, workload_file)) {
+        free(imp->tasks);
+        fclose(fp);
+        return false;
+    }
+
+    progress_begin("Trace import", 0);
+
+    char line[TRACE_LINE_MAX];
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        size_t len = strlen(line);
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n') {
+            // Overlong line: skip the remainder
+            int c;
+            while ((c = fgetc(fp)) != EOF && c != '\n') {
+            }
+            imp->malformed++;
+            continue;
+        }
+        imp->lines++;
+        if (line[0] != '#') {
+            trace_handle_line(imp, line);
+        }
+        if (monitor_enabled) {
+            progress_tick(imp->writer.written,
+                          (long long)((imp->last_ts - imp->first_ts) / imp->time_unit));
+        }
+    }
+    fclose(fp);
+
+    // Flush jobs still in progress at the end of the trace
+    for (int i = 0; i < TRACE_TASK_SLOTS; i++) {
+        TraceTask *t = &imp->tasks[i];
+        if (!t->used || !t->in_job) {
+            continue;
+        }
+        if (t->running) {
+            t->run += imp->last_ts - t->running_since;
+        }
+        if (t->run > 0) {
+            trace_emit_job(imp, t);
+        }
+    }
+
+    free(imp->tasks);
+    imp->tasks = NULL;
+    progress.completed = imp->writer.written;
+    progress_end();
+    return workload_writer_close(&imp->writer);
+}
+
+void import_trace_menu(Process processes[], int *n) {
+    char trace_file[256], workload_file[256];
+    double time_unit_us;
+
+    printf("Trace file (perf sched script / ftrace text): ");
+    if (scanf("%255s", trace_file) != 1) {
+        return;
+    }
+    printf("Output workload file: ");
+    if (scanf("%255s", workload_file) != 1) {
+        return;
+    }
+    printf("Microseconds per time unit (e.g. 1000): ");
+    if (scanf("%lf", &time_unit_us) != 1 || time_unit_us <= 0) {
+        printf("⚠ Invalid time unit!\n");
+        return;
+    }
+
+    TraceImport imp;
+    if (!import_sched_trace(trace_file, workload_file, time_unit_us, &imp)) {
+        printf("⚠ Error importing '%s'!\n", trace_file);
+        return;
+    }
+
+    printf("✓ Imported %lld jobs from %lld events (%lld lines, peak %d live tasks)\n",
+           imp.writer.written, imp.events, imp.lines, imp.peak_tasks);
+    if (imp.malformed > 0) {
+        printf("⚠ Skipped %lld malformed lines\n", imp.malformed);
+    }
+    if (imp.dropped > 0) {
+        printf("⚠ Task table full: dropped %lld events\n", imp.dropped);
+    }
+
+    // Jobs are written as they finish, so pick the earliest arrivals
+    if (load_earliest_arrivals(workload_file, processes, n)) {
+        printf("✓ Loaded %d processes\n", *n);
+    } else {
+        *n = 0;
+    }
+}
+
+void sort_by_arrival(Process processes[], int n) {
+    for (int i = 0; i < n - 1; i++) {
+        for (int j = 0; j < n - i - 1; j++) {
+            if (processes[j].arrival_time > processes[j + 1].arrival_time) {
+                Process temp = processes[j];
+                processes[j] = processes[j + 1];
+                processes[j + 1] = temp;
+            }
+        }
+    }
+}
+
+void reset_processes(Process original[], Process copy[], int n) {
+    for (int i = 0; i < n; i++) {
+        copy[i] = original[i];
+        copy[i].remaining_time = copy[i].burst_time;
+        copy[i].waiting_time = 0;
+        copy[i].turnaround_time = 0;
+        copy[i].completion_time = 0;
+        copy[i].response_time = -1;
+        copy[i].first_response = false;
+        copy[i].queue_level = 0;
+    }
+}
+
+void sim_init(SimState *st, int algorithm, Process processes[], int n, int quantum) {
+    st->algorithm = algorithm;
+    st->n = n;
+    st->quantum = quantum;
+    st->current_time = 0;
+    st->completed = 0;
+    st->front = 0;
+    st->rear = 0;
+    st->queue_cap = n + 1;
+    for (int i = 0; i < n; i++) {
+        st->flag[i] = false;
+    }
+    reset_processes(processes, st->proc, n);
+    st->next_checkpoint = checkpoint_interval;
+    progress_begin(algorithm_name(algorithm), n);
+}
+
+void sim_finish(SimState *st, Process processes[], Metrics *metrics) {
+    progress_end();
+    calculate_metrics(st->proc, st->n, st->current_time, metrics);
+
+    for (int i = 0; i < st->n; i++) {
+        processes[i] = st->proc[i];
+    }
+
+    // Run completed: a stale checkpoint must not be resumed later
+    checkpoint_wait();
+    if (checkpoint_interval > 0) {
+        remove(CHECKPOINT_FILE);
+    }
+}
+
+// FCFS Algorithm
+void fcfs(Process processes[], int n, Metrics *metrics) {
+    INSTR_BEGIN();
+    SimState st;
+    sim_init(&st, ALG_FCFS, processes, n, 0);
+    sort_by_arrival(st.proc, n);
+    fcfs_run(&st);
+    INSTR_END();
+    sim_finish(&st, processes, metrics);
+}
+
+void fcfs_run(SimState *st) {
+    Process *proc = st->proc;
+
+    while (st->completed < st->n) {
+        checkpoint_poll(st);
+
+        int i = st->completed;
+        if (st->current_time < proc[i].arrival_time) {
+            INSTR_READY(0, proc[i].arrival_time - st->current_time);
+            st->current_time = proc[i].arrival_time;
+        }
+
+#ifdef SCHED_INSTRUMENT
+        // Processes already waiting behind this one (sorted by arrival)
+        int waiting = 0;
+        for (int j = i + 1; j < st->n && proc[j].arrival_time <= st->current_time; j++) {
+            waiting++;
+        }
+        INSTR_READY(waiting, proc[i].burst_time);
+#endif
+        INSTR_DISPATCH();
+
+        proc[i].response_time = st->current_time - proc[i].arrival_time;
+        st->current_time += proc[i].burst_time;
+        proc[i].completion_time = st->current_time;
+        proc[i].turnaround_time = proc[i].completion_time - proc[i].arrival_time;
+        proc[i].waiting_time = proc[i].turnaround_time - proc[i].burst_time;
+        st->completed++;
+        if (monitor_enabled) {
+            progress_complete(&proc[i]);
+        }
+    }
+}
+
+// SJF Algorithm
+void sjf(Process processes[], int n, Metrics *metrics) {
+    INSTR_BEGIN();
+    SimState st;
+    sim_init(&st, ALG_SJF, processes, n, 0);
+    sjf_run(&st);
+    INSTR_END();
+    sim_finish(&st, processes, metrics);
+}
+
+void sjf_run(SimState *st) {
+    Process *proc = st->proc;
+    bool *visited = st->flag;
+    int n = st->n;
+
+    while (st->completed < n) {
+        checkpoint_poll(st);
+
+        int idx = -1;
+        int min_burst = 999999;
+        int ready = 0;
+
+        INSTR_SCAN(n);
+        for (int i = 0; i < n; i++) {
+            if (proc[i].arrival_time <= st->current_time && !visited[i]) {
+                ready++;
+                if (proc[i].burst_time < min_burst) {
+                    min_burst = proc[i].burst_time;
+                    idx = i;
+                }
+            }
+        }
+
+        if (idx != -1) {
+            INSTR_DISPATCH();
+            INSTR_READY(ready - 1, proc[idx].burst_time);
+            proc[idx].response_time = st->current_time - proc[idx].arrival_time;
+            st->current_time += proc[idx].burst_time;
+            proc[idx].completion_time = st->current_time;
+            proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
+            proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
+            visited[idx] = true;
+            st->completed++;
+            if (monitor_enabled) {
+                progress_complete(&proc[idx]);
+            }
+        } else {
+            INSTR_READY(0, 1);
+            st->current_time++;
+        }
+    }
+}
+
+// Priority Scheduling
+void priority_scheduling(Process processes[], int n, Metrics *metrics) {
+    INSTR_BEGIN();
+    SimState st;
+    sim_init(&st, ALG_PRIORITY, processes, n, 0);
+    priority_run(&st);
+    INSTR_END();
+    sim_finish(&st, processes, metrics);
+}
+
+void priority_run(SimState *st) {
+    Process *proc = st->proc;
+    bool *visited = st->flag;
+    int n = st->n;
+
+    while (st->completed < n) {
+        checkpoint_poll(st);
+
+        int idx = -1;
+        int highest_priority = 999999;
+        int ready = 0;
+
+        INSTR_SCAN(n);
+        for (int i = 0; i < n; i++) {
+            if (proc[i].arrival_time <= st->current_time && !visited[i]) {
+                ready++;
+                if (proc[i].priority < highest_priority) {
+                    highest_priority = proc[i].priority;
+                    idx = i;
+                }
+            }
+        }
+
+        if (idx != -1) {
+            INSTR_DISPATCH();
+            INSTR_READY(ready - 1, proc[idx].burst_time);
+            proc[idx].response_time = st->current_time - proc[idx].arrival_time;
+            st->current_time += proc[idx].burst_time;
+            proc[idx].completion_time = st->current_time;
+            proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
+            proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
+            visited[idx] = true;
+            st->completed++;
+            if (monitor_enabled) {
+                progress_complete(&proc[idx]);
+            }
+        } else {
+            INSTR_READY(0, 1);
+            st->current_time++;
+        }
+    }
+}
+
+// Round Robin Algorithm
+void round_robin(Process processes[], int n, int quantum, Metrics *metrics) {
+    INSTR_BEGIN();
+    SimState st;
+    sim_init(&st, ALG_RR, processes, n, quantum);
+    Process *proc = st.proc;
+
+    // Add first arriving process
+    int min_arrival = 999999;
+    int first_idx = 0;
+    for (int i = 0; i < n; i++) {
+        if (proc[i].arrival_time < min_arrival) {
+            min_arrival = proc[i].arrival_time;
+            first_idx = i;
+        }
+    }
+
+    st.current_time = proc[first_idx].arrival_time;
+    st.queue[st.rear].pid_idx = first_idx;
+    st.rear = (st.rear + 1) % st.queue_cap;
+    st.flag[first_idx] = true;
+
+    round_robin_run(&st);
+    INSTR_END();
+    sim_finish(&st, processes, metrics);
+}
+
+void round_robin_run(SimState *st) {
+    Process *proc = st->proc;
+    bool *in_queue = st->flag;
+    QueueItem *queue = st->queue;
+    int n = st->n;
+    int cap = st->queue_cap;   // At most n processes are queued at once
+
+    while (st->completed < n) {
+        checkpoint_poll(st);
+
+        if (st->front == st->rear) {
+            // Queue empty, find next arriving process
+            int next_arrival = 999999;
+            int next_idx = -1;
+            INSTR_SCAN(n);
+            for (int i = 0; i < n; i++) {
+                if (proc[i].remaining_time > 0 && proc[i].arrival_time > st->current_time) {
+                    if (proc[i].arrival_time < next_arrival) {
+                        next_arrival = proc[i].arrival_time;
+                        next_idx = i;
+                    }
+                }
+            }
+            if (next_idx != -1) {
+                INSTR_READY(0, proc[next_idx].arrival_time - st->current_time);
+                st->current_time = proc[next_idx].arrival_time;
+                queue[st->rear].pid_idx = next_idx;
+                st->rear = (st->rear + 1) % cap;
+                in_queue[next_idx] = true;
+            }
+            continue;
+        }
+
+        int idx = queue[st->front].pid_idx;
+        st->front = (st->front + 1) % cap;
+
+        if (proc[idx].remaining_time > 0) {
+            if (!proc[idx].first_response) {
+                proc[idx].response_time = st->current_time - proc[idx].arrival_time;
+                proc[idx].first_response = true;
+            }
+
+            int exec_time = (proc[idx].remaining_time > st->quantum) ? st->quantum : proc[idx].remaining_time;
+            INSTR_DISPATCH();
+            INSTR_READY((st->rear - st->front + cap) % cap, exec_time);
+            proc[idx].remaining_time -= exec_time;
+            st->current_time += exec_time;
+
+            // Add newly arrived processes
+            INSTR_SCAN(n);
+            for (int i = 0; i < n; i++) {
+                if (proc[i].arrival_time <= st->current_time && proc[i].remaining_time > 0 && !in_queue[i] && i != idx) {
+                    queue[st->rear].pid_idx = i;
+                    st->rear = (st->rear + 1) % cap;
+                    in_queue[i] = true;
+                }
+            }
+
+            if (proc[idx].remaining_time == 0) {
+                proc[idx].completion_time = st->current_time;
+                proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
+                proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
+                st->completed++;
+                in_queue[idx] = false;
+                if (monitor_enabled) {
+                    progress_complete(&proc[idx]);
+                }
+            } else {
+                INSTR_PREEMPT();
+                queue[st->rear].pid_idx = idx;
+                st->rear = (st->rear + 1) % cap;
+            }
+        }
+    }
+}
+
+// SRTF Algorithm (Shortest Remaining Time First) - NEW!
+void srtf(Process processes[], int n, Metrics *metrics) {
+    INSTR_BEGIN();
+    SimState st;
+    sim_init(&st, ALG_SRTF, processes, n, 0);
+    srtf_run(&st);
+    INSTR_END();
+    sim_finish(&st, processes, metrics);
+}
+
+void srtf_run(SimState *st) {
+    Process *proc = st->proc;
+    int n = st->n;
+    int last_idx = -1;   // Only used by the instrumentation counters
+
+    while (st->completed < n) {
+        checkpoint_poll(st);
+
+        int idx = -1;
+        int min_remaining = 999999;
+        int ready = 0;
+
+        // Find process with shortest remaining time
+        INSTR_SCAN(n);
+        for (int i = 0; i < n; i++) {
+            if (proc[i].arrival_time <= st->current_time && proc[i].remaining_time > 0) {
+                ready++;
+                if (proc[i].remaining_time < min_remaining) {
+                    min_remaining = proc[i].remaining_time;
+                    idx = i;
+                }
+            }
+        }
+
+        if (idx != -1) {
+            // A new decision only when the running process changes
+            if (idx != last_idx) {
+                INSTR_DISPATCH();
+                if (last_idx != -1 && proc[last_idx].remaining_time > 0) {
+                    INSTR_PREEMPT();
+                }
+                last_idx = idx;
+            }
+            INSTR_READY(ready - 1, 1);
+
+            // Record response time on first execution
+            if (!proc[idx].first_response) {
+                proc[idx].response_time = st->current_time - proc[idx].arrival_time;
+                proc[idx].first_response = true;
+            }
+
+            proc[idx].remaining_time--;
+            st->current_time++;
+
+            if (proc[idx].remaining_time == 0) {
+                proc[idx].completion_time = st->current_time;
+                proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
+                proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
+                st->completed++;
+                if (monitor_enabled) {
+                    progress_complete(&proc[idx]);
+                }
+            }
+        } else {
+            INSTR_READY(0, 1);
+            st->current_time++;
+        }
+    }
+}
+
+// MLFQ Algorithm (Multi-Level Feedback Queue) - NEW!
+void mlfq(Process processes[], int n, Metrics *metrics) {
+    INSTR_BEGIN();
+    SimState st;
+    sim_init(&st, ALG_MLFQ, processes, n, 0);
+    Process *proc = st.proc;
+
+    // Initialize all processes to queue level 0
+    for (int i = 0; i < n; i++) {
+        proc[i].queue_level = 0;
+    }
+
+    // Add first arriving process
+    int min_arrival = 999999;
+    int first_idx = 0;
+    for (int i = 0; i < n; i++) {
+        if (proc[i].arrival_time < min_arrival) {
+            min_arrival = proc[i].arrival_time;
+            first_idx = i;
+        }
+    }
+
+    st.current_time = proc[first_idx].arrival_time;
+    st.queue[st.rear].pid_idx = first_idx;
+    st.queue[st.rear].queue_level = 0;
+    st.rear++;
+    st.flag[first_idx] = true;
+
+    mlfq_run(&st);
+    INSTR_END();
+    sim_finish(&st, processes, metrics);
+}
+
+void mlfq_run(SimState *st) {
+    Process *proc = st->proc;
+    bool *in_queue = st->flag;
+    QueueItem *queue = st->queue;
+    int n = st->n;
+    int quantum[MAX_QUEUES] = {2, 4, 8, 16, 32};
+
+    while (st->completed < n) {
+        checkpoint_poll(st);
+
+        if (st->front == st->rear) {
+            int next_arrival = 999999;
+            int next_idx = -1;
+            INSTR_SCAN(n);
+            for (int i = 0; i < n; i++) {
+                if (proc[i].remaining_time > 0 && proc[i].arrival_time > st->current_time) {
                     if (proc[i].arrival_time < next_arrival) {
                         next_arrival = proc[i].arrival_time;
                         next_idx = i;
                     }
                 }
             }
-            if (next_idx != -1) {
-                current_time = proc[next_idx].arrival_time;
-                queue[rear++] = next_idx;
-                in_queue[next_idx] = true;
-            }
-            continue;
+            if (next_idx != -1) {
+                INSTR_READY(0, proc[next_idx].arrival_time - st->current_time);
+                st->current_time = proc[next_idx].arrival_time;
+                queue[st->rear].pid_idx = next_idx;
+                queue[st->rear].queue_level = proc[next_idx].queue_level;
+                st->rear++;
+                in_queue[next_idx] = true;
+            }
+            continue;
+        }
+
+        // Find highest priority (lowest queue level) process
+        int selected_idx = st->front;
+        INSTR_SCAN(st->rear - st->front);
+        for (int i = st->front; i < st->rear; i++) {
+            if (queue[i].queue_level < queue[selected_idx].queue_level) {
+                selected_idx = i;
+            }
+        }
+
+        QueueItem current = queue[selected_idx];
+        // Remove from queue by shifting
+        for (int i = selected_idx; i < st->rear - 1; i++) {
+            queue[i] = queue[i + 1];
+        }
+        st->rear--;
+
+        int idx = current.pid_idx;
+        int level = proc[idx].queue_level;
+
+        if (proc[idx].remaining_time > 0) {
+            if (!proc[idx].first_response) {
+                proc[idx].response_time = st->current_time - proc[idx].arrival_time;
+                proc[idx].first_response = true;
+            }
+
+            int time_quantum = quantum[level];
+            int exec_time = (proc[idx].remaining_time > time_quantum) ? time_quantum : proc[idx].remaining_time;
+            INSTR_DISPATCH();
+            INSTR_READY(st->rear - st->front, exec_time);
+            proc[idx].remaining_time -= exec_time;
+            st->current_time += exec_time;
+
+            // Add newly arrived processes
+            INSTR_SCAN(n);
+            for (int i = 0; i < n; i++) {
+                if (proc[i].arrival_time <= st->current_time && proc[i].remaining_time > 0 && !in_queue[i]) {
+                    queue[st->rear].pid_idx = i;
+                    queue[st->rear].queue_level = proc[i].queue_level;
+                    st->rear++;
+                    in_queue[i] = true;
+                }
+            }
+
+            if (proc[idx].remaining_time == 0) {
+                proc[idx].completion_time = st->current_time;
+                proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
+                proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
+                st->completed++;
+                in_queue[idx] = false;
+                if (monitor_enabled) {
+                    progress_complete(&proc[idx]);
+                }
+            } else {
+                // Move to lower priority queue if not completed
+                INSTR_PREEMPT();
+                if (proc[idx].queue_level < MAX_QUEUES - 1) {
+                    proc[idx].queue_level++;
+                }
+                queue[st->rear].pid_idx = idx;
+                queue[st->rear].queue_level = proc[idx].queue_level;
+                st->rear++;
+            }
+        }
+    }
+}
+
+void heap_init(MinHeap *h, int capacity) {
+    h->size = 0;
+    h->capacity = capacity > 0 ? capacity : 1;
+    h->nodes = malloc(sizeof(HeapNode) * h->capacity);
+    if (h->nodes == NULL) {
+        h->capacity = 0;
+    }
+}
+
+void heap_free(MinHeap *h) {
+    free(h->nodes);
+    h->nodes = NULL;
+    h->size = 0;
+    h->capacity = 0;
+}
+
+bool heap_less(const HeapNode *a, const HeapNode *b) {
+    if (a->key != b->key) {
+        return a->key < b->key;
+    }
+    return a->tie < b->tie;
+}
+
+bool heap_push(MinHeap *h, long long key, long long tie, int idx) {
+    if (h->size == h->capacity) {
+        int capacity = h->capacity > 0 ? h->capacity * 2 : 16;
+        HeapNode *nodes = realloc(h->nodes, sizeof(HeapNode) * capacity);
+        if (nodes == NULL) {
+            return false;
+        }
+        h->nodes = nodes;
+        h->capacity = capacity;
+    }
+
+    // Sift up
+    HeapNode node = {key, tie, idx};
+    int i = h->size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!heap_less(&node, &h->nodes[parent])) {
+            break;
+        }
+        h->nodes[i] = h->nodes[parent];
+        i = parent;
+    }
+    h->nodes[i] = node;
+    return true;
+}
+
+HeapNode heap_pop(MinHeap *h) {
+    HeapNode top = h->nodes[0];
+    HeapNode last = h->nodes[--h->size];
+
+    // Sift down
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= h->size) {
+            break;
+        }
+        if (child + 1 < h->size && heap_less(&h->nodes[child + 1], &h->nodes[child])) {
+            child++;
+        }
+        if (!heap_less(&h->nodes[child], &last)) {
+            break;
+        }
+        h->nodes[i] = h->nodes[child];
+        i = child;
+    }
+    if (h->size > 0) {
+        h->nodes[i] = last;
+    }
+    return top;
+}
+
+// Fast engines. Each returns exactly what its reference engine returns
+// (same tie-breaks, same output order) without per-time-unit scans; the
+// differential oracle checks that. They do not checkpoint.
+
+// FCFS: stable arrival order instead of a bubble sort
+void fcfs_fast(Process processes[], int n, Metrics *metrics) {
+    INSTR_BEGIN();
+    Process proc[MAX_PROCESSES];
+    int order[MAX_PROCESSES];
+    reset_processes(processes, proc, n);
+    arrival_order(proc, n, order);
+    progress_begin("FCFS (fast)", n);
+
+    int current_time = 0;
+    for (int k = 0; k < n; k++) {
+        Process *p = &processes[k];
+        *p = proc[order[k]];
+        if (current_time < p->arrival_time) {
+            current_time = p->arrival_time;
+        }
+        INSTR_DISPATCH();
+        p->response_time = current_time - p->arrival_time;
+        current_time += p->burst_time;
+        p->completion_time = current_time;
+        p->turnaround_time = p->completion_time - p->arrival_time;
+        p->waiting_time = p->turnaround_time - p->burst_time;
+        if (monitor_enabled) {
+            progress_complete(p);
+        }
+    }
+
+    INSTR_END();
+    progress_end();
+    calculate_metrics(processes, n, current_time, metrics);
+}
+
+// Non-preemptive SJF (use_priority false) or Priority (true). Ties go to
+// the lowest index, as in the reference scan
+void nonpreemptive_fast(Process processes[], int n, bool use_priority, Metrics *metrics) {
+    INSTR_BEGIN();
+    Process proc[MAX_PROCESSES];
+    int order[MAX_PROCESSES];
+    reset_processes(processes, proc, n);
+    arrival_order(proc, n, order);
+    progress_begin(use_priority ? "Priority (fast)" : "SJF (fast)", n);
+
+    MinHeap ready;
+    heap_init(&ready, n);
+    if (ready.nodes == NULL) {
+        printf("⚠ Out of memory!\n");
+        return;
+    }
+    int current_time = 0, completed = 0, next_arrival = 0;
+
+    while (completed < n) {
+        while (next_arrival < n && proc[order[next_arrival]].arrival_time <= current_time) {
+            int i = order[next_arrival++];
+            INSTR_HEAP();
+            heap_push(&ready, use_priority ? proc[i].priority : proc[i].burst_time, i, i);
+        }
+        if (ready.size == 0) {
+            current_time = proc[order[next_arrival]].arrival_time;
+            continue;
+        }
+
+        INSTR_DISPATCH();
+        INSTR_HEAP();
+        int idx = heap_pop(&ready).idx;
+        proc[idx].response_time = current_time - proc[idx].arrival_time;
+        current_time += proc[idx].burst_time;
+        proc[idx].completion_time = current_time;
+        proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
+        proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
+        completed++;
+        if (monitor_enabled) {
+            progress_complete(&proc[idx]);
+        }
+    }
+
+    INSTR_END();
+    progress_end();
+    heap_free(&ready);
+    calculate_metrics(proc, n, current_time, metrics);
+    for (int i = 0; i < n; i++) {
+        processes[i] = proc[i];
+    }
+}
+
+void sjf_fast(Process processes[], int n, Metrics *metrics) {
+    nonpreemptive_fast(processes, n, false, metrics);
+}
+
+void priority_fast(Process processes[], int n, Metrics *metrics) {
+    nonpreemptive_fast(processes, n, true, metrics);
+}
+
+// SRTF, event-driven. The reference picks the lowest (remaining, index)
+// every time unit; between arrivals the running process only gets
+// shorter, so that choice can change only when something arrives.
+void srtf_fast(Process processes[], int n, Metrics *metrics) {
+    INSTR_BEGIN();
+    Process proc[MAX_PROCESSES];
+    int order[MAX_PROCESSES];
+    reset_processes(processes, proc, n);
+    arrival_order(proc, n, order);
+    progress_begin("SRTF (fast)", n);
+
+    MinHeap ready;
+    heap_init(&ready, n);
+    if (ready.nodes == NULL) {
+        printf("⚠ Out of memory!\n");
+        return;
+    }
+    int current_time = 0, completed = 0, next_arrival = 0;
+    int running = -1;
+
+    while (completed < n) {
+        while (next_arrival < n && proc[order[next_arrival]].arrival_time <= current_time) {
+            int i = order[next_arrival++];
+            INSTR_HEAP();
+            heap_push(&ready, proc[i].remaining_time, i, i);
+        }
+
+        if (running != -1 && ready.size > 0) {
+            HeapNode current = {proc[running].remaining_time, running, running};
+            if (heap_less(&ready.nodes[0], &current)) {
+                INSTR_PREEMPT();
+                INSTR_HEAP();
+                heap_push(&ready, current.key, current.tie, running);
+                running = -1;
+            }
+        }
+
+        if (running == -1) {
+            if (ready.size == 0) {
+                current_time = proc[order[next_arrival]].arrival_time;
+                continue;
+            }
+            INSTR_DISPATCH();
+            INSTR_HEAP();
+            running = heap_pop(&ready).idx;
+            if (!proc[running].first_response) {
+                proc[running].response_time = current_time - proc[running].arrival_time;
+                proc[running].first_response = true;
+            }
+        }
+
+        int next_event = current_time + proc[running].remaining_time;
+        if (next_arrival < n && proc[order[next_arrival]].arrival_time < next_event) {
+            next_event = proc[order[next_arrival]].arrival_time;
+        }
+        proc[running].remaining_time -= next_event - current_time;
+        current_time = next_event;
+
+        if (proc[running].remaining_time == 0) {
+            proc[running].completion_time = current_time;
+            proc[running].turnaround_time = proc[running].completion_time - proc[running].arrival_time;
+            proc[running].waiting_time = proc[running].turnaround_time - proc[running].burst_time;
+            completed++;
+            if (monitor_enabled) {
+                progress_complete(&proc[running]);
+            }
+            running = -1;
+        }
+    }
+
+    INSTR_END();
+    progress_end();
+    heap_free(&ready);
+    calculate_metrics(proc, n, current_time, metrics);
+    for (int i = 0; i < n; i++) {
+        processes[i] = proc[i];
+    }
+}
+
+// Admit every process that has arrived by current_time, in index order
+// (the order of the reference scan). Processes before *next in arrival
+// order are already admitted, so the new ones are a contiguous run.
+int admit_by_index(const Process proc[], int n, const int order[], int *next,
+                   int current_time, int batch[]) {
+    int count = 0;
+    while (*next < n && proc[order[*next]].arrival_time <= current_time) {
+        int i = order[(*next)++];
+        int j = count++;
+        while (j > 0 && batch[j - 1] > i) {
+            batch[j] = batch[j - 1];
+            j--;
+        }
+        batch[j] = i;
+    }
+    return count;
+}
+
+// Round Robin (queue_levels 1, fixed quantum) or MLFQ (MAX_QUEUES levels).
+// Like the reference, an idle CPU admits only the earliest arrival (lowest
+// index on ties); others arriving at the same time join after its slice.
+void slice_fast(Process processes[], int n, int levels, int rr_quantum, Metrics *metrics) {
+    INSTR_BEGIN();
+    Process proc[MAX_PROCESSES];
+    int order[MAX_PROCESSES], batch[MAX_PROCESSES];
+    reset_processes(processes, proc, n);
+    arrival_order(proc, n, order);
+    progress_begin(levels == 1 ? "Round Robin (fast)" : "MLFQ (fast)", n);
+
+    int mlfq_quantum[MAX_QUEUES] = {2, 4, 8, 16, 32};
+    int queue[MAX_QUEUES][MAX_PROCESSES + 1];
+    int head[MAX_QUEUES] = {0}, tail[MAX_QUEUES] = {0};
+    int cap = n + 1;
+
+    int next = 0, completed = 0;
+    int current_time = proc[order[0]].arrival_time;
+    queue[0][tail[0]] = order[next++];
+    tail[0] = (tail[0] + 1) % cap;
+
+    while (completed < n) {
+        int level = 0;
+        while (level < levels && head[level] == tail[level]) {
+            level++;
+        }
+        if (level == levels) {
+            current_time = proc[order[next]].arrival_time;
+            queue[0][tail[0]] = order[next++];
+            tail[0] = (tail[0] + 1) % cap;
+            continue;
+        }
+
+        int idx = queue[level][head[level]];
+        head[level] = (head[level] + 1) % cap;
+        if (!proc[idx].first_response) {
+            proc[idx].response_time = current_time - proc[idx].arrival_time;
+            proc[idx].first_response = true;
+        }
+
+        int quantum = levels == 1 ? rr_quantum : mlfq_quantum[proc[idx].queue_level];
+        int exec_time = proc[idx].remaining_time > quantum ? quantum : proc[idx].remaining_time;
+        INSTR_DISPATCH();
+        proc[idx].remaining_time -= exec_time;
+        current_time += exec_time;
+
+        int count = admit_by_index(proc, n, order, &next, current_time, batch);
+        for (int k = 0; k < count; k++) {
+            queue[0][tail[0]] = batch[k];
+            tail[0] = (tail[0] + 1) % cap;
+        }
+
+        if (proc[idx].remaining_time == 0) {
+            proc[idx].completion_time = current_time;
+            proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
+            proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
+            completed++;
+            if (monitor_enabled) {
+                progress_complete(&proc[idx]);
+            }
+        } else {
+            INSTR_PREEMPT();
+            if (levels > 1 && proc[idx].queue_level < MAX_QUEUES - 1) {
+                proc[idx].queue_level++;
+            }
+            int to = levels == 1 ? 0 : proc[idx].queue_level;
+            queue[to][tail[to]] = idx;
+            tail[to] = (tail[to] + 1) % cap;
+        }
+    }
+
+    INSTR_END();
+    progress_end();
+    calculate_metrics(proc, n, current_time, metrics);
+    for (int i = 0; i < n; i++) {
+        processes[i] = proc[i];
+    }
+}
+
+void round_robin_fast(Process processes[], int n, int quantum, Metrics *metrics) {
+    slice_fast(processes, n, 1, quantum, metrics);
+}
+
+void mlfq_fast(Process processes[], int n, Metrics *metrics) {
+    slice_fast(processes, n, MAX_QUEUES, 0, metrics);
+}
+
+// Preemptive Priority Scheduling with aging - NEW!
+//
+// Aging is lazy: a waiting process gains one priority level every
+// aging_interval time units, so its effective priority at time t is
+// priority - (t - enqueue_time) / aging_interval. Comparing two waiting
+// processes, that ordering never changes, so the heap key is simply
+// priority * aging_interval + enqueue_time and is never touched again.
+// The running process stops aging; the time at which the waiting head
+// overtakes it follows from the two keys and becomes one more event.
+// Every event costs O(log n) regardless of how many processes wait.
+void priority_preemptive(Process processes[], int n, int aging_interval, Metrics *metrics) {
+    INSTR_BEGIN();
+    Process proc[MAX_PROCESSES];
+    reset_processes(processes, proc, n);
+
+    bool aging = aging_interval > 0;
+    long long scale = aging ? aging_interval : 1;
+
+    // Arrival order (ties by index) so arrivals are admitted in O(1)
+    int order[MAX_PROCESSES];
+    arrival_order(proc, n, order);
+
+    MinHeap ready;
+    heap_init(&ready, n);
+    if (ready.nodes == NULL) {
+        printf("⚠ Out of memory!\n");
+        return;
+    }
+
+    progress_begin("Preemptive Priority", n);
+
+    long long current_time = 0;
+    long long running_key = 0, dispatch_time = 0;
+    int completed = 0, next_arrival = 0;
+    int running = -1;
+
+    while (completed < n) {
+        if (running == -1 && ready.size == 0 && next_arrival < n &&
+            proc[order[next_arrival]].arrival_time > current_time) {
+            INSTR_READY(0, proc[order[next_arrival]].arrival_time - current_time);
+            current_time = proc[order[next_arrival]].arrival_time;
+        }
+
+        // Admit arrivals
+        while (next_arrival < n && proc[order[next_arrival]].arrival_time <= current_time) {
+            int i = order[next_arrival++];
+            INSTR_HEAP();
+            heap_push(&ready, proc[i].priority * scale + (aging ? current_time : 0), i, i);
+        }
+
+        // Preempt when the waiting head beats the running process now. The
+        // running process keeps the aging it earned while waiting, so its
+        // key slides forward by the time it has been on the CPU.
+        if (running != -1 && ready.size > 0) {
+            long long key = running_key + (aging ? current_time - dispatch_time : 0);
+            if (ready.nodes[0].key < key) {
+                INSTR_PREEMPT();
+                INSTR_HEAP();
+                heap_push(&ready, key, running, running);
+                running = -1;
+            }
+        }
+
+        if (running == -1) {
+            INSTR_DISPATCH();
+            INSTR_HEAP();
+            HeapNode top = heap_pop(&ready);
+            running = top.idx;
+            running_key = top.key;
+            dispatch_time = current_time;
+            if (!proc[running].first_response) {
+                proc[running].response_time = (int)(current_time - proc[running].arrival_time);
+                proc[running].first_response = true;
+            }
+        }
+
+        // Next event: completion, arrival, or the waiting head aging past us
+        long long next_event = current_time + proc[running].remaining_time;
+        if (next_arrival < n && proc[order[next_arrival]].arrival_time < next_event) {
+            next_event = proc[order[next_arrival]].arrival_time;
+        }
+        if (aging && ready.size > 0) {
+            long long overtake = ready.nodes[0].key - running_key + dispatch_time + 1;
+            if (overtake < next_event) {
+                next_event = overtake;
+            }
+        }
+
+        INSTR_READY(ready.size, next_event - current_time);
+        proc[running].remaining_time -= (int)(next_event - current_time);
+        current_time = next_event;
+
+        if (proc[running].remaining_time == 0) {
+            proc[running].completion_time = (int)current_time;
+            proc[running].turnaround_time = proc[running].completion_time - proc[running].arrival_time;
+            proc[running].waiting_time = proc[running].turnaround_time - proc[running].burst_time;
+            completed++;
+            if (monitor_enabled) {
+                progress_complete(&proc[running]);
+            }
+            running = -1;
+        }
+    }
+
+    heap_free(&ready);
+    INSTR_END();
+    progress_end();
+    calculate_metrics(proc, n, (int)current_time, metrics);
+
+    for (int i = 0; i < n; i++) {
+        processes[i] = proc[i];
+    }
+}
+
+// Default class for workloads that do not carry one
+int classify_process(int burst, int priority) {
+    if (priority <= 2) {
+        return CLASS_SYSTEM;
+    }
+    return burst <= 15 ? CLASS_INTERACTIVE : CLASS_BATCH;
+}
+
+const char *class_name(int proc_class) {
+    switch (proc_class) {
+        case CLASS_SYSTEM:      return "System";
+        case CLASS_INTERACTIVE: return "Interactive";
+        case CLASS_BATCH:       return "Batch";
+        default:                return "Unknown";
+    }
+}
+
+const char *mlq_policy_name(int policy) {
+    switch (policy) {
+        case MLQ_RR:   return "RR";
+        case MLQ_FCFS: return "FCFS";
+        case MLQ_SJF:  return "SJF";
+        case MLQ_SRTF: return "SRTF";
+        default:       return "?";
+    }
+}
+
+void mlq_default_config(MLQConfig *config) {
+    config->mode = MLQ_WEIGHTED;
+    config->policy[CLASS_SYSTEM] = MLQ_RR;
+    config->quantum[CLASS_SYSTEM] = 2;
+    config->share[CLASS_SYSTEM] = 20;
+    config->policy[CLASS_INTERACTIVE] = MLQ_RR;
+    config->quantum[CLASS_INTERACTIVE] = 4;
+    config->share[CLASS_INTERACTIVE] = 50;
+    config->policy[CLASS_BATCH] = MLQ_FCFS;
+    config->quantum[CLASS_BATCH] = 0;
+    config->share[CLASS_BATCH] = 30;
+}
+
+// Indices sorted by arrival time, ties by index
+void arrival_order(Process proc[], int n, int order[]) {
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    for (int i = 1; i < n; i++) {
+        int key = order[i];
+        int j = i - 1;
+        while (j >= 0 && proc[order[j]].arrival_time > proc[key].arrival_time) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = key;
+    }
+}
+
+// Remove position pos from a class queue, keeping the order of the rest
+int mlq_take(int queue[], int *count, int pos) {
+    int idx = queue[pos];
+    for (int i = pos; i < *count - 1; i++) {
+        queue[i] = queue[i + 1];
+    }
+    (*count)--;
+    return idx;
+}
+
+// Multilevel Queue Scheduling - NEW!
+// Static classes (system, interactive, batch), each with its own policy.
+// Between classes the CPU goes either by strict class priority or by
+// weighted time slicing: stride scheduling where each class advances its
+// pass value by MLQ_STRIDE / share per time unit it runs, and the ready
+// class with the lowest pass runs next.
+void multilevel_queue(Process processes[], int n, const MLQConfig *config,
+                      Metrics *metrics, Metrics class_metrics[], int class_counts[]) {
+    INSTR_BEGIN();
+    Process proc[MAX_PROCESSES];
+    reset_processes(processes, proc, n);
+    progress_begin("Multilevel Queue", n);
+
+    int order[MAX_PROCESSES];
+    arrival_order(proc, n, order);
+
+    int queue[NUM_CLASSES][MAX_PROCESSES];
+    int count[NUM_CLASSES] = {0};
+    int running[NUM_CLASSES];       // Process holding the class's CPU turn
+    int slice_left[NUM_CLASSES] = {0};
+    long long pass[NUM_CLASSES] = {0};
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        running[c] = -1;
+    }
+
+    int current_time = 0, completed = 0, next_arrival = 0;
+    int last_idx = -1;
+    int requeue = -1;               // RR process whose slice just expired
+
+    while (completed < n) {
+        // Admit arrivals
+        while (next_arrival < n && proc[order[next_arrival]].arrival_time <= current_time) {
+            int i = order[next_arrival++];
+            int c = proc[i].proc_class;
+
+            // A class waking up from idle starts at the lowest active pass,
+            // so it cannot claim the CPU time it did not use while idle
+            bool active = count[c] > 0 || running[c] != -1 ||
+                          (requeue != -1 && proc[requeue].proc_class == c);
+            if (config->mode == MLQ_WEIGHTED && !active) {
+                long long min_pass = -1;
+                for (int k = 0; k < NUM_CLASSES; k++) {
+                    if (k != c && (count[k] > 0 || running[k] != -1) &&
+                        (min_pass < 0 || pass[k] < min_pass)) {
+                        min_pass = pass[k];
+                    }
+                }
+                if (min_pass > pass[c]) {
+                    pass[c] = min_pass;
+                }
+            }
+            queue[c][count[c]++] = i;
+        }
+
+        // An expired RR process goes behind the processes that arrived
+        // during its last time unit, as in round_robin()
+        if (requeue != -1) {
+            int c = proc[requeue].proc_class;
+            queue[c][count[c]++] = requeue;
+            requeue = -1;
+        }
+
+        // Pick the class
+        int cls = -1;
+        for (int c = 0; c < NUM_CLASSES; c++) {
+            if (count[c] == 0 && running[c] == -1) {
+                continue;
+            }
+            if (config->mode == MLQ_STRICT) {
+                cls = c;
+                break;
+            }
+            if (cls == -1 || pass[c] < pass[cls]) {
+                cls = c;
+            }
+        }
+
+        if (cls == -1) {
+            // Idle until the next arrival
+            INSTR_READY(0, proc[order[next_arrival]].arrival_time - current_time);
+            current_time = proc[order[next_arrival]].arrival_time;
+            continue;
+        }
+
+        // Pick the process within the class
+        int policy = config->policy[cls];
+        if (policy == MLQ_SRTF) {
+            int best = -1;
+            INSTR_SCAN(count[cls]);
+            for (int k = 0; k < count[cls]; k++) {
+                if (best == -1 || proc[queue[cls][k]].remaining_time < proc[queue[cls][best]].remaining_time) {
+                    best = k;
+                }
+            }
+            if (best != -1 && (running[cls] == -1 ||
+                proc[queue[cls][best]].remaining_time < proc[running[cls]].remaining_time)) {
+                int idx = mlq_take(queue[cls], &count[cls], best);
+                if (running[cls] != -1) {
+                    queue[cls][count[cls]++] = running[cls];
+                }
+                running[cls] = idx;
+            }
+        } else if (running[cls] == -1) {
+            int pos = 0;
+            if (policy == MLQ_SJF) {
+                INSTR_SCAN(count[cls]);
+                for (int k = 1; k < count[cls]; k++) {
+                    if (proc[queue[cls][k]].burst_time < proc[queue[cls][pos]].burst_time) {
+                        pos = k;
+                    }
+                }
+            }
+            running[cls] = mlq_take(queue[cls], &count[cls], pos);
+            slice_left[cls] = config->quantum[cls];
+        }
+
+        int idx = running[cls];
+        if (idx != last_idx) {
+            INSTR_DISPATCH();
+            if (last_idx != -1 && proc[last_idx].remaining_time > 0) {
+                INSTR_PREEMPT();
+            }
+            last_idx = idx;
+        }
+        INSTR_READY(count[0] + count[1] + count[2], 1);
+
+        if (!proc[idx].first_response) {
+            proc[idx].response_time = current_time - proc[idx].arrival_time;
+            proc[idx].first_response = true;
+        }
+
+        // Run one time unit
+        proc[idx].remaining_time--;
+        current_time++;
+        if (config->mode == MLQ_WEIGHTED) {
+            int share = config->share[cls] > 0 ? config->share[cls] : 1;
+            pass[cls] += MLQ_STRIDE / share;
+        }
+
+        if (proc[idx].remaining_time == 0) {
+            proc[idx].completion_time = current_time;
+            proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
+            proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
+            completed++;
+            running[cls] = -1;
+            if (monitor_enabled) {
+                progress_complete(&proc[idx]);
+            }
+        } else if (policy == MLQ_RR && --slice_left[cls] == 0) {
+            INSTR_PREEMPT();
+            running[cls] = -1;
+            requeue = idx;
+        }
+    }
+
+    INSTR_END();
+    progress_end();
+    calculate_metrics(proc, n, current_time, metrics);
+    mlq_class_metrics(proc, n, current_time, class_metrics, class_counts);
+
+    for (int i = 0; i < n; i++) {
+        processes[i] = proc[i];
+    }
+}
+
+// Per-class metrics over the same total time, so each class's CPU
+// utilization is its share of the CPU
+void mlq_class_metrics(const Process proc[], int n, int total_time,
+                       Metrics class_metrics[], int class_counts[]) {
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        Process members[MAX_PROCESSES];
+        int k = 0;
+        for (int i = 0; i < n; i++) {
+            if (proc[i].proc_class == c) {
+                members[k++] = proc[i];
+            }
+        }
+        class_counts[c] = k;
+        if (k > 0) {
+            calculate_metrics(members, k, total_time, &class_metrics[c]);
+        } else {
+            memset(&class_metrics[c], 0, sizeof(Metrics));
+        }
+    }
+}
+
+void print_class_metrics(FILE *fp, const MLQConfig *config,
+                         const Metrics class_metrics[], const int class_counts[]) {
+    fprintf(fp, "\nPer-Class Metrics (%s):\n",
+            config->mode == MLQ_STRICT ? "strict priority" : "weighted time slicing");
+    fprintf(fp, "Class\t\tPolicy\tShare\tCount\tAvg Wait\tAvg Turnaround\tAvg Response\tCPU Used\n");
+    fprintf(fp, "--------------------------------------------------------------------------------------------\n");
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        char policy[16];
+        if (config->policy[c] == MLQ_RR) {
+            snprintf(policy, sizeof(policy), "RR(%d)", config->quantum[c]);
+        } else {
+            snprintf(policy, sizeof(policy), "%s", mlq_policy_name(config->policy[c]));
+        }
+        char share[8];
+        if (config->mode == MLQ_WEIGHTED) {
+            snprintf(share, sizeof(share), "%d%%", config->share[c]);
+        } else {
+            snprintf(share, sizeof(share), "-");
+        }
+        fprintf(fp, "%-12s\t%s\t%s\t%d\t%.2f\t\t%.2f\t\t%.2f\t\t%.2f%%\n",
+                class_name(c), policy, share, class_counts[c],
+                class_metrics[c].avg_waiting_time, class_metrics[c].avg_turnaround_time,
+                class_metrics[c].avg_response_time, class_metrics[c].cpu_utilization);
+    }
+}
+
+void save_class_metrics(const MLQConfig *config, const Metrics class_metrics[], const int class_counts[]) {
+    FILE *fp = fopen("scheduling_results.txt", "a");
+    if (fp == NULL) {
+        printf("⚠ Error opening file for writing!\n");
+        return;
+    }
+    print_class_metrics(fp, config, class_metrics, class_counts);
+    fprintf(fp, "\n");
+    fclose(fp);
+}
+
+bool configure_mlq(MLQConfig *config) {
+    mlq_default_config(config);
+
+    printf("\nUse default configuration? (1 = yes, 0 = no)\n");
+    printf("  System: RR(q=2) 20%%, Interactive: RR(q=4) 50%%, Batch: FCFS 30%%, weighted\n");
+    printf("Choice: ");
+    int use_default;
+    if (scanf("%d", &use_default) != 1) {
+        return false;
+    }
+    if (use_default == 1) {
+        return true;
+    }
+
+    printf("Share enforcement (1 = strict priority, 2 = weighted time slicing): ");
+    if (scanf("%d", &config->mode) != 1 || config->mode < MLQ_STRICT || config->mode > MLQ_WEIGHTED) {
+        printf("⚠ Invalid choice!\n");
+        return false;
+    }
+
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        printf("\n%s class policy (1 = RR, 2 = FCFS, 3 = SJF, 4 = SRTF): ", class_name(c));
+        if (scanf("%d", &config->policy[c]) != 1 || config->policy[c] < MLQ_RR || config->policy[c] > MLQ_SRTF) {
+            printf("⚠ Invalid policy!\n");
+            return false;
+        }
+        if (config->policy[c] == MLQ_RR) {
+            printf("%s time quantum: ", class_name(c));
+            if (scanf("%d", &config->quantum[c]) != 1 || config->quantum[c] <= 0) {
+                printf("⚠ Invalid quantum!\n");
+                return false;
+            }
+        }
+        if (config->mode == MLQ_WEIGHTED) {
+            printf("%s CPU share (%%): ", class_name(c));
+            if (scanf("%d", &config->share[c]) != 1 || config->share[c] <= 0) {
+                printf("⚠ Invalid share!\n");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+const char *placement_name(int placement) {
+    switch (placement) {
+        case PLACE_FASTEST:      return "Fastest-Available";
+        case PLACE_PROPORTIONAL: return "Load-Proportional";
+        case PLACE_MIGRATE:      return "Migrate-Long";
+        default:                 return "Unknown";
+    }
+}
+
+int compare_ints(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of an ascending array
+int percentile_of_sorted(const int values[], int count, double pct) {
+    if (count == 0) {
+        return 0;
+    }
+    int rank = (int)ceil(pct / 100.0 * count);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return values[rank - 1];
+}
+
+// Heterogeneous Multi-Core Scheduling (big.LITTLE) - NEW!
+// Bursts are work, not time: a core with speed s completes s units of
+// work per time unit. Work is tracked in thousandths so runs are exact.
+// Cores are numbered big first, so scanning in order prefers big cores.
+void heterogeneous_cores(Process processes[], int n, const CoreConfig *config,
+                         Metrics *metrics, CoreStats *stats) {
+    INSTR_BEGIN();
+    Process proc[MAX_PROCESSES];
+    reset_processes(processes, proc, n);
+    progress_begin(placement_name(config->placement), n);
+
+    int cores = config->big_cores + config->little_cores;
+    long long speed[MAX_CORES];
+    for (int c = 0; c < cores; c++) {
+        double s = (c < config->big_cores) ? config->big_speed : config->little_speed;
+        speed[c] = (long long)(s * 1000.0 + 0.5);
+        if (speed[c] < 1) speed[c] = 1;  // Never let a core stall the clock
+    }
+
+    int order[MAX_PROCESSES];
+    arrival_order(proc, n, order);
+
+    // Waiting time is turnaround minus time actually spent on a core,
+    // which is shorter than the burst on fast cores
+    long long work_left[MAX_PROCESSES];
+    int run_time[MAX_PROCESSES];
+    int finished_on[MAX_PROCESSES];
+    for (int i = 0; i < n; i++) {
+        work_left[i] = proc[i].burst_time * 1000LL;
+        run_time[i] = 0;
+        finished_on[i] = -1;
+    }
+
+    // Global FIFO (fastest-available, migrate) or per-core FIFOs
+    // (load-proportional, where pending_work drives placement)
+    int global_queue[MAX_PROCESSES];
+    int global_head = 0, global_tail = 0;
+    int core_queue[MAX_CORES][MAX_PROCESSES];
+    int core_head[MAX_CORES] = {0}, core_tail[MAX_CORES] = {0};
+    long long pending_work[MAX_CORES] = {0};
+
+    int job[MAX_CORES];
+    long long busy[MAX_CORES] = {0};
+    for (int c = 0; c < cores; c++) {
+        job[c] = -1;
+    }
+
+    int current_time = 0, completed = 0, next_arrival = 0;
+    memset(stats, 0, sizeof(*stats));
+
+    while (completed < n) {
+        // Admit arrivals
+        while (next_arrival < n && proc[order[next_arrival]].arrival_time <= current_time) {
+            int i = order[next_arrival++];
+            if (config->placement == PLACE_PROPORTIONAL) {
+                // Core that would finish this job soonest given its backlog
+                int best = 0;
+                for (int c = 1; c < cores; c++) {
+                    INSTR_SCAN(1);
+                    if ((pending_work[c] + work_left[i]) * speed[best] <
+                        (pending_work[best] + work_left[i]) * speed[c]) {
+                        best = c;
+                    }
+                }
+                core_queue[best][core_tail[best]++] = i;
+                pending_work[best] += work_left[i];
+            } else {
+                global_queue[global_tail++] = i;
+            }
+        }
+
+        // Dispatch to idle cores, fastest first
+        for (int c = 0; c < cores; c++) {
+            if (job[c] != -1) {
+                continue;
+            }
+            int idx = -1;
+            if (config->placement == PLACE_PROPORTIONAL) {
+                if (core_head[c] < core_tail[c]) {
+                    idx = core_queue[c][core_head[c]++];
+                }
+            } else if (global_head < global_tail) {
+                idx = global_queue[global_head++];
+            } else if (config->placement == PLACE_MIGRATE && c < config->big_cores) {
+                // Nothing waiting: pull the longest job off a little core
+                int from = -1;
+                for (int k = config->big_cores; k < cores; k++) {
+                    INSTR_SCAN(1);
+                    if (job[k] != -1 && work_left[job[k]] >= MIGRATE_MIN_WORK * 1000LL &&
+                        (from == -1 || work_left[job[k]] > work_left[job[from]])) {
+                        from = k;
+                    }
+                }
+                if (from != -1 && speed[c] > speed[from]) {
+                    idx = job[from];
+                    job[from] = -1;
+                    stats->migrations++;
+                    INSTR_PREEMPT();
+                }
+            }
+            if (idx == -1) {
+                continue;
+            }
+
+            job[c] = idx;
+            INSTR_DISPATCH();
+            if (!proc[idx].first_response) {
+                proc[idx].response_time = current_time - proc[idx].arrival_time;
+                proc[idx].first_response = true;
+            }
+        }
+
+        int running = 0;
+        for (int c = 0; c < cores; c++) {
+            if (job[c] != -1) {
+                running++;
+            }
+        }
+        if (running == 0) {
+            // Idle until the next arrival
+            INSTR_READY(0, proc[order[next_arrival]].arrival_time - current_time);
+            current_time = proc[order[next_arrival]].arrival_time;
+            continue;
+        }
+        INSTR_READY(global_tail - global_head, 1);
+
+        // Run one time unit on every busy core
+        current_time++;
+        for (int c = 0; c < cores; c++) {
+            int idx = job[c];
+            if (idx == -1) {
+                continue;
+            }
+            long long done = work_left[idx] < speed[c] ? work_left[idx] : speed[c];
+            work_left[idx] -= done;
+            run_time[idx]++;
+            busy[c]++;
+            if (config->placement == PLACE_PROPORTIONAL) {
+                pending_work[c] -= done;
+            }
+
+            if (work_left[idx] == 0) {
+                proc[idx].remaining_time = 0;
+                proc[idx].completion_time = current_time;
+                proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
+                proc[idx].waiting_time = proc[idx].turnaround_time - run_time[idx];
+                finished_on[idx] = c < config->big_cores ? CORE_BIG : CORE_LITTLE;
+                job[c] = -1;
+                completed++;
+                if (monitor_enabled) {
+                    progress_complete(&proc[idx]);
+                }
+            }
+        }
+    }
+
+    INSTR_END();
+    progress_end();
+    calculate_metrics(proc, n, current_time, metrics);
+
+    // Utilization is busy core-time over available core-time
+    long long total_busy = 0;
+    for (int c = 0; c < cores; c++) {
+        int cls = c < config->big_cores ? CORE_BIG : CORE_LITTLE;
+        stats->busy_time[cls] += busy[c];
+        total_busy += busy[c];
+    }
+    stats->utilization[CORE_BIG] = config->big_cores > 0 && current_time > 0
+        ? 100.0 * stats->busy_time[CORE_BIG] / ((double)config->big_cores * current_time) : 0.0;
+    stats->utilization[CORE_LITTLE] = config->little_cores > 0 && current_time > 0
+        ? 100.0 * stats->busy_time[CORE_LITTLE] / ((double)config->little_cores * current_time) : 0.0;
+    metrics->cpu_utilization = current_time > 0
+        ? 100.0 * total_busy / ((double)cores * current_time) : 0.0;
+
+    // Turnaround distribution overall and by the core class that finished the job
+    int all[MAX_PROCESSES], by_class[2][MAX_PROCESSES];
+    int counts[2] = {0, 0};
+    for (int i = 0; i < n; i++) {
+        all[i] = proc[i].turnaround_time;
+        by_class[finished_on[i]][counts[finished_on[i]]++] = proc[i].turnaround_time;
+    }
+    qsort(all, n, sizeof(int), compare_ints);
+    stats->p50 = percentile_of_sorted(all, n, 50.0);
+    stats->p90 = percentile_of_sorted(all, n, 90.0);
+    stats->p99 = percentile_of_sorted(all, n, 99.0);
+    for (int cls = 0; cls < 2; cls++) {
+        qsort(by_class[cls], counts[cls], sizeof(int), compare_ints);
+        stats->jobs[cls] = counts[cls];
+        stats->class_p50[cls] = percentile_of_sorted(by_class[cls], counts[cls], 50.0);
+        stats->class_p90[cls] = percentile_of_sorted(by_class[cls], counts[cls], 90.0);
+    }
+
+    for (int i = 0; i < n; i++) {
+        processes[i] = proc[i];
+    }
+}
+
+void print_core_stats(FILE *fp, const CoreConfig *config, const CoreStats *stats) {
+    fprintf(fp, "\nCore Classes (%s placement):\n", placement_name(config->placement));
+    fprintf(fp, "Class\tCores\tSpeed\tUtilization\tJobs Finished\tTurnaround p50\tp90\n");
+    fprintf(fp, "--------------------------------------------------------------------\n");
+    fprintf(fp, "Big\t%d\t%.2fx\t%.2f%%\t\t%d\t\t%d\t\t%d\n",
+            config->big_cores, config->big_speed, stats->utilization[CORE_BIG],
+            stats->jobs[CORE_BIG], stats->class_p50[CORE_BIG], stats->class_p90[CORE_BIG]);
+    fprintf(fp, "Little\t%d\t%.2fx\t%.2f%%\t\t%d\t\t%d\t\t%d\n",
+            config->little_cores, config->little_speed, stats->utilization[CORE_LITTLE],
+            stats->jobs[CORE_LITTLE], stats->class_p50[CORE_LITTLE], stats->class_p90[CORE_LITTLE]);
+    fprintf(fp, "Turnaround p50 / p90 / p99:  %d / %d / %d\n", stats->p50, stats->p90, stats->p99);
+    fprintf(fp, "Migrations:                  %d\n", stats->migrations);
+}
+
+void heterogeneous_menu(Process processes[], int n) {
+    CoreConfig config;
+
+    printf("\nNumber of big cores (0-%d): ", MAX_CORES);
+    if (scanf("%d", &config.big_cores) != 1 || config.big_cores < 0 || config.big_cores > MAX_CORES) {
+        printf("⚠ Invalid number of cores!\n");
+        return;
+    }
+    printf("Big core speed factor (e.g. 2.0): ");
+    if (scanf("%lf", &config.big_speed) != 1 || config.big_speed < MIN_CORE_SPEED) {
+        printf("⚠ Invalid speed (minimum %.3f)!\n", MIN_CORE_SPEED);
+        return;
+    }
+    printf("Number of little cores (0-%d): ", MAX_CORES - config.big_cores);
+    if (scanf("%d", &config.little_cores) != 1 || config.little_cores < 0 ||
+        config.big_cores + config.little_cores > MAX_CORES ||
+        config.big_cores + config.little_cores == 0) {
+        printf("⚠ Invalid number of cores!\n");
+        return;
+    }
+    printf("Little core speed factor (e.g. 1.0): ");
+    if (scanf("%lf", &config.little_speed) != 1 || config.little_speed < MIN_CORE_SPEED ||
+        (config.big_cores > 0 && config.little_speed > config.big_speed)) {
+        printf("⚠ Invalid speed (minimum %.3f, and little cores must not be faster than big cores)!\n",
+               MIN_CORE_SPEED);
+        return;
+    }
+
+    printf("\nPlacement policy:\n");
+    printf("1. Fastest available core\n");
+    printf("2. Load-proportional (per-core queues)\n");
+    printf("3. Migrate long jobs to big cores\n");
+    printf("4. Compare all three\n");
+    printf("Choice: ");
+    int choice;
+    if (scanf("%d", &choice) != 1 || choice < 1 || choice > 4) {
+        printf("⚠ Invalid choice!\n");
+        return;
+    }
+
+    Metrics metrics;
+    CoreStats stats;
+    char label[64];
+
+    if (choice != 4) {
+        config.placement = choice;
+        Process *results = cached_output(heterogeneous_cached(processes, n, &config, &metrics, &stats),
+                                         processes);
+        snprintf(label, sizeof(label), "Heterogeneous (%s)", placement_name(choice));
+        print_results(results, n, metrics, label);
+        print_core_stats(stdout, &config, &stats);
+        save_to_file(results, n, metrics, label);
+        FILE *fp = fopen("scheduling_results.txt", "a");
+        if (fp != NULL) {
+            print_core_stats(fp, &config, &stats);
+            fclose(fp);
+        }
+        return;
+    }
+
+    printf("\n%-20s %10s %10s %10s %8s %8s %8s\n",
+           "Placement", "Avg Wait", "Avg TAT", "Makespan", "Big %", "Little %", "p99 TAT");
+    for (int placement = PLACE_FASTEST; placement <= PLACE_MIGRATE; placement++) {
+        Process copy[MAX_PROCESSES];
+        reset_processes(processes, copy, n);
+        config.placement = placement;
+        Process *results = cached_output(heterogeneous_cached(copy, n, &config, &metrics, &stats), copy);
+        printf("%-20s %10.2f %10.2f %10d %7.1f%% %7.1f%% %8d\n",
+               placement_name(placement), metrics.avg_waiting_time, metrics.avg_turnaround_time,
+               metrics.total_time, stats.utilization[CORE_BIG], stats.utilization[CORE_LITTLE],
+               stats.p99);
+
+        snprintf(label, sizeof(label), "Heterogeneous (%s)", placement_name(placement));
+        save_to_file(results, n, metrics, label);
+        FILE *fp = fopen("scheduling_results.txt", "a");
+        if (fp != NULL) {
+            print_core_stats(fp, &config, &stats);
+            fclose(fp);
+        }
+    }
+}
+
+// Write a snapshot whenever the simulated clock passes the next checkpoint.
+// The check is a single comparison, so the hot loop pays nothing otherwise.
+void checkpoint_poll(SimState *st) {
+    if (checkpoint_interval <= 0 || st->current_time < st->next_checkpoint) {
+        return;
+    }
+
+    // While the previous snapshot is still being written, try again on
+    // the next iteration instead of blocking
+    if (checkpoint_write_async(st)) {
+        st->next_checkpoint = st->current_time + checkpoint_interval;
+    }
+}
+
+// Snapshot the state by forking: the child owns a copy-on-write image of
+// it and does the file I/O, so the simulation only pays for the fork.
+// Returns false if the previous writer has not finished yet.
+bool checkpoint_write_async(const SimState *st) {
+#ifdef PARALLEL_SUPPORTED
+    if (checkpoint_writer > 0) {
+        if (waitpid(checkpoint_writer, NULL, WNOHANG) == 0) {
+            return false;
+        }
+        checkpoint_writer = -1;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        _exit(save_checkpoint(st) ? 0 : 1);
+    }
+    if (pid > 0) {
+        checkpoint_writer = pid;
+        return true;
+    }
+#endif
+    // No fork available (or it failed): write inline
+    save_checkpoint(st);
+    return true;
+}
+
+// Block until an in-flight snapshot is on disk
+void checkpoint_wait() {
+#ifdef PARALLEL_SUPPORTED
+    if (checkpoint_writer > 0) {
+        waitpid(checkpoint_writer, NULL, 0);
+        checkpoint_writer = -1;
+    }
+#endif
+}
+
+bool save_checkpoint(const SimState *st) {
+    // Write to a temporary file and rename, so a crash mid-write never
+    // destroys the previous good checkpoint
+    const char *tmp_name = CHECKPOINT_FILE ".tmp";
+    FILE *fp = fopen(tmp_name, "wb");
+    if (fp == NULL) {
+        return false;
+    }
+
+    CheckpointHeader header;
+    header.magic = CHECKPOINT_MAGIC;
+    header.version = CHECKPOINT_VERSION;
+    header.algorithm = st->algorithm;
+    header.n = st->n;
+    header.quantum = st->quantum;
+    header.current_time = st->current_time;
+    header.completed = st->completed;
+    header.front = st->front;
+    header.rear = st->rear;
+    header.queue_cap = st->queue_cap;
+
+    unsigned char flags[MAX_PROCESSES];
+    for (int i = 0; i < st->n; i++) {
+        flags[i] = st->flag[i];
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(st->queue, sizeof(QueueItem), st->queue_cap, fp) == (size_t)st->queue_cap &&
+              fwrite(flags, 1, st->n, fp) == (size_t)st->n &&
+              fwrite(st->proc, sizeof(Process), st->n, fp) == (size_t)st->n;
+
+    if (fclose(fp) != 0) {
+        ok = false;
+    }
+    if (!ok || rename(tmp_name, CHECKPOINT_FILE) != 0) {
+        remove(tmp_name);
+        return false;
+    }
+    return true;
+}
+
+bool load_checkpoint(SimState *st) {
+    FILE *fp = fopen(CHECKPOINT_FILE, "rb");
+    if (fp == NULL) {
+        return false;
+    }
+
+    CheckpointHeader header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        header.magic != CHECKPOINT_MAGIC ||
+        header.version != CHECKPOINT_VERSION ||
+        header.algorithm < ALG_FCFS || header.algorithm > ALG_MLFQ ||
+        header.n <= 0 || header.n > MAX_PROCESSES ||
+        header.queue_cap != header.n + 1 ||
+        header.front < 0 || header.front >= header.queue_cap ||
+        header.rear < 0 || header.rear >= header.queue_cap) {
+        fclose(fp);
+        return false;
+    }
+
+    st->algorithm = header.algorithm;
+    st->n = header.n;
+    st->quantum = header.quantum;
+    st->current_time = header.current_time;
+    st->completed = header.completed;
+    st->front = header.front;
+    st->rear = header.rear;
+    st->queue_cap = header.queue_cap;
+
+    // Flags (and each Process's first_response) are checked as bytes
+    // before any is used as a bool: a value other than 0 or 1 in bool
+    // storage is undefined behaviour
+    unsigned char flags[MAX_PROCESSES];
+    bool ok = fread(st->queue, sizeof(QueueItem), st->queue_cap, fp) == (size_t)st->queue_cap &&
+              fread(flags, 1, st->n, fp) == (size_t)st->n &&
+              fread(st->proc, sizeof(Process), st->n, fp) == (size_t)st->n;
+    fclose(fp);
+    for (int i = 0; ok && i < st->n; i++) {
+        unsigned char first_response;
+        memcpy(&first_response, (const unsigned char *)&st->proc[i] + offsetof(Process, first_response),
+               sizeof(first_response));
+        if (flags[i] > 1 || first_response > 1) {
+            ok = false;
+        } else {
+            st->flag[i] = flags[i];
+        }
+    }
+
+    st->next_checkpoint = st->current_time + checkpoint_interval;
+    return ok && checkpoint_valid(st);
+}
+
+// Reject snapshots the engines could not resume safely: every index they
+// follow must be in range, and the completed count must match the
+// per-process state so the run can terminate
+bool checkpoint_valid(const SimState *st) {
+    int n = st->n;
+    if (st->current_time < 0 || st->completed < 0 || st->completed > n) {
+        return false;
+    }
+    if (st->algorithm == ALG_RR && st->quantum <= 0) {
+        return false;
+    }
+
+    int finished = 0, flagged = 0;
+    for (int i = 0; i < n; i++) {
+        const Process *p = &st->proc[i];
+        if (p->arrival_time < 0 || p->burst_time <= 0 ||
+            p->remaining_time < 0 || p->remaining_time > p->burst_time ||
+            p->queue_level < 0 || p->queue_level >= MAX_QUEUES) {
+            return false;
+        }
+        finished += p->remaining_time == 0;
+        flagged += st->flag[i];
+    }
+
+    switch (st->algorithm) {
+        case ALG_SJF:
+        case ALG_PRIORITY:
+            // flag = visited
+            return flagged == st->completed;
+
+        case ALG_SRTF:
+            return finished == st->completed;
+
+        case ALG_RR:
+        case ALG_MLFQ: {
+            // flag = in_queue: exactly the queued, unfinished processes
+            if (finished != st->completed ||
+                (st->algorithm == ALG_MLFQ && st->front > st->rear)) {
+                return false;
+            }
+            bool seen[MAX_PROCESSES] = {false};
+            int queued = 0;
+            for (int i = st->front; i != st->rear; i = (i + 1) % st->queue_cap) {
+                const QueueItem *q = &st->queue[i];
+                if (q->pid_idx < 0 || q->pid_idx >= n || seen[q->pid_idx] ||
+                    !st->flag[q->pid_idx] || st->proc[q->pid_idx].remaining_time == 0 ||
+                    q->queue_level < 0 || q->queue_level >= MAX_QUEUES) {
+                    return false;
+                }
+                seen[q->pid_idx] = true;
+                queued++;
+            }
+            return queued == flagged;
+        }
+
+        default:
+            return true;
+    }
+}
+
+const char *algorithm_name(int algorithm) {
+    switch (algorithm) {
+        case ALG_FCFS:     return "FCFS";
+        case ALG_SJF:      return "SJF";
+        case ALG_PRIORITY: return "Priority";
+        case ALG_RR:       return "Round Robin";
+        case ALG_SRTF:     return "SRTF";
+        case ALG_MLFQ:     return "MLFQ";
+        default:           return "Unknown";
+    }
+}
+
+void resume_from_checkpoint(Process processes[], int *n) {
+    SimState st;
+    if (!load_checkpoint(&st)) {
+        printf("⚠ No valid checkpoint found in '%s'!\n", CHECKPOINT_FILE);
+        return;
+    }
+
+    printf("✓ Resuming %s at time %d (%d/%d processes completed)\n",
+           algorithm_name(st.algorithm), st.current_time, st.completed, st.n);
+
+    progress_restore(algorithm_name(st.algorithm), st.proc, st.n);
+    INSTR_BEGIN();
+    switch (st.algorithm) {
+        case ALG_FCFS:     fcfs_run(&st); break;
+        case ALG_SJF:      sjf_run(&st); break;
+        case ALG_PRIORITY: priority_run(&st); break;
+        case ALG_RR:       round_robin_run(&st); break;
+        case ALG_SRTF:     srtf_run(&st); break;
+        case ALG_MLFQ:     mlfq_run(&st); break;
+    }
+    INSTR_END();
+
+    // The resumed workload becomes the loaded process set
+    Metrics metrics = {0};
+    *n = st.n;
+    sim_finish(&st, processes, &metrics);
+    remove(CHECKPOINT_FILE);
+
+    print_results(processes, *n, metrics, algorithm_name(st.algorithm));
+    save_to_file(processes, *n, metrics, algorithm_name(st.algorithm));
+}
+
+void configure_checkpointing() {
+    printf("\nCurrent checkpoint interval: ");
+    if (checkpoint_interval > 0) {
+        printf("%d time units\n", checkpoint_interval);
+    } else {
+        printf("disabled\n");
+    }
+
+    printf("Enter checkpoint interval in time units (0 = disable): ");
+    int interval;
+    if (scanf("%d", &interval) != 1 || interval < 0) {
+        printf("⚠ Invalid interval!\n");
+        return;
+    }
+
+    checkpoint_interval = interval;
+    if (checkpoint_interval > 0) {
+        printf("✓ Checkpoints will be written to '%s' every %d time units\n",
+               CHECKPOINT_FILE, checkpoint_interval);
+    } else {
+        printf("✓ Checkpointing disabled\n");
+    }
+}
+
+// FNV-1a, 64-bit
+uint64_t fnv1a(uint64_t hash, const void *data, size_t len) {
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// Key for one run: policy, its parameters and the workload inputs, hashed
+// with the simulator version. Result fields are left out, so a workload
+// keys the same before and after it has been scheduled.
+void cache_key(CacheKey *key, const char *policy, const int params[], int nparams,
+               const Process processes[], int n) {
+    memset(key, 0, sizeof(*key));
+    snprintf(key->policy, sizeof(key->policy), "%s", policy);
+    key->nparams = nparams;
+    for (int i = 0; i < nparams; i++) {
+        key->params[i] = params[i];
+    }
+    key->n = n;
+    for (int i = 0; i < n; i++) {
+        key->input[i][0] = processes[i].pid;
+        key->input[i][1] = processes[i].arrival_time;
+        key->input[i][2] = processes[i].burst_time;
+        key->input[i][3] = processes[i].priority;
+        key->input[i][4] = processes[i].proc_class;
+        key->input[i][5] = processes[i].width;
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    uint32_t version = SIM_VERSION;
+    hash = fnv1a(hash, &version, sizeof(version));
+    hash = fnv1a(hash, key->policy, cache_key_size(key) - offsetof(CacheKey, policy));
+    key->hash = hash;
+}
+
+// Bytes of the key in use: everything up to the last process
+size_t cache_key_size(const CacheKey *key) {
+    return offsetof(CacheKey, input) + sizeof(key->input[0]) * key->n;
+}
+
+void cache_path(uint64_t hash, char *path, size_t size) {
+    snprintf(path, size, "%s/%016llx.bin", CACHE_DIR, (unsigned long long)hash);
+}
+
+// Load a cached run. A full hit replaces processes[] with the stored
+// per-process results (in the engine's output order); a metrics-only hit
+// fills in metrics and extra alone
+CacheResult cache_lookup(const CacheKey *key, Process processes[], int n, Metrics *metrics,
+                         void *extra, size_t extra_size) {
+    if (!cache_enabled) {
+        return CACHE_MISS;
+    }
+
+    char path[64];
+    cache_path(key->hash, path, sizeof(path));
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        cache_stats.misses++;
+        return CACHE_MISS;
+    }
+
+    CacheHeader header;
+    CacheKey stored_key;
+    Process stored[MAX_PROCESSES];
+    size_t key_size = cache_key_size(key);
+    bool ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+              header.magic == CACHE_MAGIC &&
+              header.version == SIM_VERSION &&
+              header.key == key->hash &&
+              header.n == n &&
+              header.extra_size == (int32_t)extra_size &&
+              fread(&stored_key, key_size, 1, fp) == 1 &&
+              memcmp(&stored_key, key, key_size) == 0;
+    if (ok && header.has_processes) {
+        ok = fread(stored, sizeof(Process), n, fp) == (size_t)n;
+    }
+    if (ok && extra_size > 0) {
+        ok = fread(extra, extra_size, 1, fp) == 1;
+    }
+    fclose(fp);
+
+    if (!ok) {
+        // Stale, truncated or colliding entry: recompute and overwrite
+        cache_stats.misses++;
+        return CACHE_MISS;
+    }
+
+    *metrics = header.metrics;
+    cache_stats.hits++;
+    if (!header.has_processes) {
+        return CACHE_HIT_METRICS;
+    }
+    for (int i = 0; i < n; i++) {
+        processes[i] = stored[i];
+    }
+    return CACHE_HIT;
+}
+
+void cache_store(const CacheKey *key, const Process processes[], int n, const Metrics *metrics,
+                 const void *extra, size_t extra_size) {
+    if (!cache_enabled) {
+        return;
+    }
+    make_directory(CACHE_DIR);
+
+    char path[64], tmp_name[72];
+    cache_path(key->hash, path, sizeof(path));
+    snprintf(tmp_name, sizeof(tmp_name), "%s.tmp", path);
+    FILE *fp = fopen(tmp_name, "wb");
+    if (fp == NULL) {
+        cache_stats.errors++;
+        return;
+    }
+
+    CacheHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = CACHE_MAGIC;
+    header.version = SIM_VERSION;
+    header.key = key->hash;
+    header.n = n;
+    header.has_processes = cache_store_processes;
+    header.extra_size = (int32_t)extra_size;
+    header.metrics = *metrics;
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(key, cache_key_size(key), 1, fp) == 1;
+    if (ok && cache_store_processes) {
+        ok = fwrite(processes, sizeof(Process), n, fp) == (size_t)n;
+    }
+    if (ok && extra_size > 0) {
+        ok = fwrite(extra, extra_size, 1, fp) == 1;
+    }
+    if (fclose(fp) != 0) {
+        ok = false;
+    }
+    if (!ok || rename(tmp_name, path) != 0) {
+        remove(tmp_name);
+        cache_stats.errors++;
+        return;
+    }
+    cache_stats.stores++;
+}
+
+// What to print for a cached run: NULL when only the metrics were stored
+Process *cached_output(CacheResult hit, Process processes[]) {
+    return hit == CACHE_HIT_METRICS ? NULL : processes;
+}
+
+// Cache key names of the base algorithms, indexed by Algorithm
+const char *cache_policy_names[] = {"", "FCFS", "SJF", "Priority", "RR", "SRTF", "MLFQ"};
+
+// One of the six base algorithms through the result cache: a hit loads
+// the stored run, a miss simulates (with the reference engine) and stores it
+CacheResult run_cached(int algorithm, Process processes[], int n, int quantum, Metrics *metrics) {
+    int params[] = {quantum};
+    CacheKey key;
+    cache_key(&key, cache_policy_names[algorithm], params, algorithm == ALG_RR ? 1 : 0,
+              processes, n);
+    CacheResult hit = cache_lookup(&key, processes, n, metrics, NULL, 0);
+    if (hit == CACHE_MISS) {
+        oracle_run(algorithm, false, processes, n, quantum, metrics);
+        cache_store(&key, processes, n, metrics, NULL, 0);
+    }
+    return hit;
+}
+
+CacheResult priority_preemptive_cached(Process processes[], int n, int aging, Metrics *metrics) {
+    int params[] = {aging};
+    CacheKey key;
+    cache_key(&key, "PPrio", params, 1, processes, n);
+    CacheResult hit = cache_lookup(&key, processes, n, metrics, NULL, 0);
+    if (hit == CACHE_MISS) {
+        priority_preemptive(processes, n, aging, metrics);
+        cache_store(&key, processes, n, metrics, NULL, 0);
+    }
+    return hit;
+}
+
+// The per-class results are stored with the run, so even a metrics-only
+// hit can report them
+CacheResult mlq_cached(Process processes[], int n, const MLQConfig *config, Metrics *metrics,
+                       Metrics class_metrics[], int class_counts[]) {
+    int params[1 + 3 * NUM_CLASSES];
+    params[0] = config->mode;
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        params[1 + c] = config->policy[c];
+        params[1 + NUM_CLASSES + c] = config->quantum[c];
+        params[1 + 2 * NUM_CLASSES + c] = config->share[c];
+    }
+    CacheKey key;
+    cache_key(&key, "MLQ", params, 1 + 3 * NUM_CLASSES, processes, n);
+
+    MLQClassResults classes;
+    CacheResult hit = cache_lookup(&key, processes, n, metrics, &classes, sizeof(classes));
+    if (hit == CACHE_MISS) {
+        multilevel_queue(processes, n, config, metrics, class_metrics, class_counts);
+        memset(&classes, 0, sizeof(classes));
+        for (int c = 0; c < NUM_CLASSES; c++) {
+            classes.metrics[c] = class_metrics[c];
+            classes.counts[c] = class_counts[c];
+        }
+        cache_store(&key, processes, n, metrics, &classes, sizeof(classes));
+        return CACHE_MISS;
+    }
+    for (int c = 0; c < NUM_CLASSES; c++) {
+        class_metrics[c] = classes.metrics[c];
+        class_counts[c] = classes.counts[c];
+    }
+    return hit;
+}
+
+// Speed factors go into the key as their raw bytes, two ints each
+CacheResult heterogeneous_cached(Process processes[], int n, const CoreConfig *config,
+                                 Metrics *metrics, CoreStats *stats) {
+    int params[3 + 2 * sizeof(double) / sizeof(int)];
+    params[0] = config->big_cores;
+    params[1] = config->little_cores;
+    params[2] = config->placement;
+    memcpy(&params[3], &config->big_speed, sizeof(double));
+    memcpy(&params[3 + sizeof(double) / sizeof(int)], &config->little_speed, sizeof(double));
+    CacheKey key;
+    cache_key(&key, "Hetero", params, sizeof(params) / sizeof(params[0]), processes, n);
+
+    CacheResult hit = cache_lookup(&key, processes, n, metrics, stats, sizeof(*stats));
+    if (hit == CACHE_MISS) {
+        heterogeneous_cores(processes, n, config, metrics, stats);
+        cache_store(&key, processes, n, metrics, stats, sizeof(*stats));
+    }
+    return hit;
+}
+
+// Count (or delete) the entries in the cache directory
+int cache_scan(bool clear, long long *bytes) {
+    DIR *dir = opendir(CACHE_DIR);
+    int entries = 0;
+    *bytes = 0;
+    if (dir == NULL) {
+        return 0;
+    }
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        size_t len = strlen(ent->d_name);
+        if (len < 4 || strcmp(ent->d_name + len - 4, ".bin") != 0) {
+            continue;
+        }
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%s", CACHE_DIR, ent->d_name);
+        FILE *fp = fopen(path, "rb");
+        if (fp != NULL) {
+            fseek(fp, 0, SEEK_END);
+            *bytes += ftell(fp);
+            fclose(fp);
+        }
+        if (clear) {
+            remove(path);
+        }
+        entries++;
+    }
+    closedir(dir);
+    return entries;
+}
+
+void print_cache_report(FILE *fp) {
+    long long total = cache_stats.hits + cache_stats.misses;
+    fprintf(fp, "Result cache: %lld hits, %lld misses", cache_stats.hits, cache_stats.misses);
+    if (total > 0) {
+        fprintf(fp, " (%.1f%% hit rate)", 100.0 * cache_stats.hits / total);
+    }
+    fprintf(fp, ", %lld stored", cache_stats.stores);
+    if (cache_stats.errors > 0) {
+        fprintf(fp, ", %lld write errors", cache_stats.errors);
+    }
+    fprintf(fp, "\n");
+}
+
+void cache_menu() {
+    long long bytes;
+    int entries = cache_scan(false, &bytes);
+
+    printf("\nResult cache (%s, simulator version %d)\n", CACHE_DIR, SIM_VERSION);
+    printf("  Status:      %s\n", cache_enabled ? "enabled" : "disabled");
+    printf("  Stores:      %s\n", cache_store_processes ? "metrics + per-process results" : "metrics only");
+    printf("  On disk:     %d entries, %lld bytes\n", entries, bytes);
+    printf("  ");
+    print_cache_report(stdout);
+
+    printf("\n1. Toggle cache\n");
+    printf("2. Toggle per-process results\n");
+    printf("3. Clear cache\n");
+    printf("4. Reset hit/miss counters\n");
+    printf("0. Back\n");
+    printf("Choice: ");
+    int choice;
+    if (scanf("%d", &choice) != 1) {
+        printf("⚠ Invalid choice!\n");
+        return;
+    }
+
+    switch (choice) {
+        case 1:
+            cache_enabled = !cache_enabled;
+            printf("✓ Result cache %s\n", cache_enabled ? "enabled" : "disabled");
+            break;
+        case 2:
+            cache_store_processes = !cache_store_processes;
+            printf("✓ New entries store %s\n",
+                   cache_store_processes ? "metrics + per-process results" : "metrics only");
+            break;
+        case 3:
+            entries = cache_scan(true, &bytes);
+            printf("✓ Removed %d entries (%lld bytes)\n", entries, bytes);
+            break;
+        case 4:
+            memset(&cache_stats, 0, sizeof(cache_stats));
+            printf("✓ Counters reset\n");
+            break;
+        case 0:
+            break;
+        default:
+            printf("⚠ Invalid choice!\n");
+    }
+}
+
+const char *open_policy_name(int policy) {
+    switch (policy) {
+        case OPEN_FCFS:     return "FCFS";
+        case OPEN_SJF:      return "SJF";
+        case OPEN_PRIORITY: return "Priority";
+        case OPEN_RR:       return "Round Robin";
+        case OPEN_SRTF:     return "SRTF";
+        default:            return "Unknown";
+    }
+}
+
+// Welford's online mean and variance
+void stat_add(RunningStat *s, double x) {
+    s->count++;
+    double delta = x - s->mean;
+    s->mean += delta / s->count;
+    s->m2 += delta * (x - s->mean);
+}
+
+double stat_stddev(const RunningStat *s) {
+    return s->count > 1 ? sqrt(s->m2 / (s->count - 1)) : 0.0;
+}
+
+bool pool_init(JobPool *pool, int capacity) {
+    pool->jobs = malloc(sizeof(OpenJob) * capacity);
+    pool->free_slots = malloc(sizeof(int) * capacity);
+    pool->capacity = capacity;
+    pool->free_count = 0;
+    pool->in_use = 0;
+    if (pool->jobs == NULL || pool->free_slots == NULL) {
+        pool_free(pool);
+        return false;
+    }
+    // Hand out low slots first
+    for (int i = capacity - 1; i >= 0; i--) {
+        pool->free_slots[pool->free_count++] = i;
+    }
+    return true;
+}
+
+void pool_free(JobPool *pool) {
+    free(pool->jobs);
+    free(pool->free_slots);
+    pool->jobs = NULL;
+    pool->free_slots = NULL;
+    pool->capacity = 0;
+    pool->free_count = 0;
+    pool->in_use = 0;
+}
+
+// Slot for a new job, doubling the pool when all slots are in flight
+int pool_alloc(JobPool *pool) {
+    if (pool->free_count == 0) {
+        if (pool->capacity > INT_MAX / 2) {
+            return -1;
+        }
+        int capacity = pool->capacity * 2;
+        if ((size_t)capacity > SIZE_MAX / sizeof(OpenJob)) {
+            return -1;
+        }
+        // Both arrays must hold the new capacity before it is committed.
+        // realloc frees the old block on success, so each pointer is kept
+        // as soon as it moves; a failure leaves a larger array behind but
+        // capacity and the free list unchanged
+        int *free_slots = realloc(pool->free_slots, sizeof(int) * (size_t)capacity);
+        if (free_slots == NULL) {
+            return -1;
+        }
+        pool->free_slots = free_slots;
+        OpenJob *jobs = realloc(pool->jobs, sizeof(OpenJob) * (size_t)capacity);
+        if (jobs == NULL) {
+            return -1;
+        }
+        pool->jobs = jobs;
+        for (int i = capacity - 1; i >= pool->capacity; i--) {
+            pool->free_slots[pool->free_count++] = i;
+        }
+        pool->capacity = capacity;
+    }
+    pool->in_use++;
+    return pool->free_slots[--pool->free_count];
+}
+
+void pool_release(JobPool *pool, int slot) {
+    pool->in_use--;
+    pool->free_slots[pool->free_count++] = slot;
+}
+
+// Ready-heap key: FCFS and RR order by enqueue sequence, the rest by
+// their criterion with the job's arrival sequence breaking ties. Returns
+// false when the heap cannot grow
+bool open_enqueue(MinHeap *ready, const OpenJob *job, int slot, int policy, long long *enqueue_seq) {
+    long long key;
+    switch (policy) {
+        case OPEN_SJF:      key = job->burst; break;
+        case OPEN_PRIORITY: key = job->priority; break;
+        case OPEN_SRTF:     key = job->remaining; break;
+        case OPEN_RR:       key = (*enqueue_seq)++; break;
+        case OPEN_FCFS:
+        default:            key = job->seq; break;
+    }
+    INSTR_HEAP();
+    return heap_push(ready, key, job->seq, slot);
+}
+
+// Open-System Steady-State Simulation - NEW!
+// Arrivals are drawn from the workload generator as the clock reaches
+// them, and completed jobs are folded into running statistics and freed.
+// Memory is the in-flight jobs plus fixed-size accumulators, however many
+// jobs the run retires. Jobs arriving before the warmup time are simulated
+// but not measured. The run stops when the 95% confidence interval of mean
+// turnaround (batch means) is within target_precision of the mean, or at
+// the time limit.
+bool open_system(const WorkloadSpec *spec, const OpenConfig *config, OpenStats *stats) {
+    INSTR_BEGIN();
+    memset(stats, 0, sizeof(*stats));
+
+    JobPool pool;
+    MinHeap ready;
+    if (!pool_init(&pool, 64)) {
+        return false;
+    }
+    heap_init(&ready, 64);
+    if (ready.nodes == NULL) {
+        pool_free(&pool);
+        return false;
+    }
+
+    WorkloadGenerator gen;
+    workload_init(&gen, spec);
+    progress_begin("Open system", 0);
+
+    // dispatch_time: when remaining was last brought up to date;
+    // slice_start: when the running job got the CPU (RR quantum)
+    long long now = 0, enqueue_seq = 0, dispatch_time = 0, slice_start = 0;
+    int running = -1;
+    bool ok = true;
+
+    // Next arrival, drawn one ahead of the clock
+    long long next_arrival = (long long)workload_next_arrival(&gen);
+    int next_burst = workload_next_burst(&gen);
+
+    while (now < config->time_limit) {
+        // Next event: arrival, completion, or the end of an RR slice
+        long long event = next_arrival;
+        if (running != -1) {
+            long long done = dispatch_time + pool.jobs[running].remaining;
+            if (config->policy == OPEN_RR && slice_start + config->quantum < done) {
+                done = slice_start + config->quantum;
+            }
+            if (done <= event) {
+                event = done;
+            }
+        }
+        if (event > config->time_limit) {
+            event = config->time_limit;
+        }
+
+        // Time-weighted accounting over the measured part of [now, event)
+        long long from = now > config->warmup_time ? now : config->warmup_time;
+        if (event > from) {
+            long long span = event - from;
+            stats->area_in_system += (double)pool.in_use * span;
+            if (running != -1) {
+                stats->busy_time += span;
+            }
+        }
+        INSTR_READY(ready.size, event - now);
+        now = event;
+        if (now >= config->time_limit) {
+            break;
+        }
+
+        bool slice_over = false;
+        if (running != -1) {
+            OpenJob *job = &pool.jobs[running];
+            job->remaining -= now - dispatch_time;
+            dispatch_time = now;
+
+            if (job->remaining == 0) {
+                // Retire into the accumulators and free the slot
+                if (job->arrival >= config->warmup_time) {
+                    long long turnaround = now - job->arrival;
+                    stat_add(&stats->turnaround, (double)turnaround);
+                    stat_add(&stats->waiting, (double)(turnaround - job->burst));
+                    stat_add(&stats->response, (double)(job->first_run - job->arrival));
+                    stats->turnaround_hist[latency_bucket(turnaround)]++;
+
+                    stats->batch_sum += turnaround;
+                    if (++stats->batch_fill == config->batch_size) {
+                        stat_add(&stats->batch_means, stats->batch_sum / config->batch_size);
+                        stats->batch_sum = 0;
+                        stats->batch_fill = 0;
+                        if (stats->batch_means.count >= OPEN_MIN_BATCHES) {
+                            stats->ci_half_width = OPEN_Z95 * stat_stddev(&stats->batch_means) /
+                                                   sqrt((double)stats->batch_means.count);
+                            if (stats->ci_half_width <= config->target_precision * stats->batch_means.mean) {
+                                stats->converged = true;
+                            }
+                        }
+                    }
+                } else {
+                    stats->discarded++;
+                }
+                stats->completed++;
+                pool_release(&pool, running);
+                running = -1;
+                if (monitor_enabled) {
+                    progress_tick(stats->completed, now);
+                }
+                if (stats->converged) {
+                    break;
+                }
+            } else if (config->policy == OPEN_RR && now - slice_start == config->quantum) {
+                slice_over = true;
+            }
         }
 
-        int idx = queue[front++];
-
-        if (proc[idx].remaining_time > 0) {
-            if (!proc[idx].first_response) {
-                proc[idx].response_time = current_time - proc[idx].arrival_time;
-                proc[idx].first_response = true;
+        // Admit the arrival due now (several may share a time unit)
+        while (next_arrival == now) {
+            int slot = pool_alloc(&pool);
+            if (slot == -1) {
+                ok = false;
+                break;
+            }
+            OpenJob *job = &pool.jobs[slot];
+            job->seq = stats->arrivals++;
+            job->arrival = now;
+            job->burst = next_burst;
+            job->remaining = next_burst;
+            job->priority = 1 + (int)(rng_next(&gen.rng) % 10);
+            job->first_run = -1;
+            if (!open_enqueue(&ready, job, slot, config->policy, &enqueue_seq)) {
+                // The job never entered the system
+                pool_release(&pool, slot);
+                stats->arrivals--;
+                ok = false;
+                break;
+            }
+            if (pool.in_use > stats->peak_in_flight) {
+                stats->peak_in_flight = pool.in_use;
             }
 
-            int exec_time = (proc[idx].remaining_time > quantum) ? quantum : proc[idx].remaining_time;
-            proc[idx].remaining_time -= exec_time;
-            current_time += exec_time;
+            next_arrival = (long long)workload_next_arrival(&gen);
+            next_burst = workload_next_burst(&gen);
+        }
+        if (!ok) {
+            break;
+        }
 
-            // Add newly arrived processes
-            for (int i = 0; i < n; i++) {
-                if (proc[i].arrival_time <= current_time && proc[i].remaining_time > 0 && !in_queue[i] && i != idx) {
-                    queue[rear++] = i;
-                    in_queue[i] = true;
-                }
+        // An expired RR slice queues behind arrivals at the same instant
+        if (slice_over) {
+            INSTR_PREEMPT();
+            if (!open_enqueue(&ready, &pool.jobs[running], running, config->policy, &enqueue_seq)) {
+                ok = false;
+                break;
             }
+            running = -1;
+        }
 
-            if (proc[idx].remaining_time == 0) {
-                proc[idx].completion_time = current_time;
-                proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
-                proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
-                completed++;
-                in_queue[idx] = false;
-            } else {
-                queue[rear++] = idx;
+        // SRTF: a shorter arrival takes the CPU
+        if (running != -1 && config->policy == OPEN_SRTF && ready.size > 0 &&
+            ready.nodes[0].key < pool.jobs[running].remaining) {
+            INSTR_PREEMPT();
+            if (!open_enqueue(&ready, &pool.jobs[running], running, config->policy, &enqueue_seq)) {
+                ok = false;
+                break;
+            }
+            running = -1;
+        }
+
+        if (running == -1 && ready.size > 0) {
+            INSTR_DISPATCH();
+            INSTR_HEAP();
+            running = heap_pop(&ready).idx;
+            dispatch_time = now;
+            slice_start = now;
+            if (pool.jobs[running].first_run == -1) {
+                pool.jobs[running].first_run = now;
             }
         }
     }
 
-    calculate_metrics(proc, n, current_time, metrics);
+    stats->end_time = now;
+    stats->in_flight_at_end = pool.in_use;
+    stats->pool_capacity = pool.capacity;
 
-    for (int i = 0; i < n; i++) {
-        processes[i] = proc[i];
+    INSTR_END();
+    progress_end();
+    heap_free(&ready);
+    pool_free(&pool);
+    return ok;
+}
+
+void print_open_stats(FILE *fp, const WorkloadSpec *spec, const OpenConfig *config,
+                      const OpenStats *stats) {
+    double measured = (double)(stats->end_time - config->warmup_time);
+    long long count = stats->turnaround.count;
+
+    fprintf(fp, "\n=== Open System: %s", open_policy_name(config->policy));
+    if (config->policy == OPEN_RR) {
+        fprintf(fp, " (q=%d)", config->quantum);
+    }
+    fprintf(fp, ", offered load %.2f ===\n", spec->target_utilization);
+    fprintf(fp, "Stopped:               %s\n",
+            stats->converged ? "confidence interval reached" : "time limit");
+    fprintf(fp, "Simulated time:        %lld (warmup %lld)\n", stats->end_time, config->warmup_time);
+    fprintf(fp, "Jobs arrived:          %lld\n", stats->arrivals);
+    fprintf(fp, "Jobs measured:         %lld (%lld warmup jobs discarded)\n", count, stats->discarded);
+    if (count == 0) {
+        fprintf(fp, "No jobs completed after the warmup period.\n");
+        return;
     }
+    fprintf(fp, "Avg Waiting Time:      %.2f (sd %.2f)\n",
+            stats->waiting.mean, stat_stddev(&stats->waiting));
+    fprintf(fp, "Avg Turnaround Time:   %.2f (sd %.2f)", stats->turnaround.mean,
+            stat_stddev(&stats->turnaround));
+    if (stats->batch_means.count >= 2) {
+        double half = OPEN_Z95 * stat_stddev(&stats->batch_means) / sqrt((double)stats->batch_means.count);
+        fprintf(fp, ", 95%% CI ±%.2f over %lld batches", half, stats->batch_means.count);
+    }
+    fprintf(fp, "\n");
+    fprintf(fp, "Avg Response Time:     %.2f (sd %.2f)\n",
+            stats->response.mean, stat_stddev(&stats->response));
+    fprintf(fp, "Turnaround p50/p95/p99: %.0f / %.0f / %.0f\n",
+            latency_percentile(stats->turnaround_hist, count, 50.0),
+            latency_percentile(stats->turnaround_hist, count, 95.0),
+            latency_percentile(stats->turnaround_hist, count, 99.0));
+    if (measured > 0) {
+        fprintf(fp, "CPU Utilization:       %.2f%%\n", 100.0 * stats->busy_time / measured);
+        fprintf(fp, "Throughput:            %.4f jobs/unit\n", count / measured);
+        fprintf(fp, "Mean jobs in system:   %.2f\n", stats->area_in_system / measured);
+    }
+    fprintf(fp, "Peak in flight:        %d (pool of %d slots)\n",
+            stats->peak_in_flight, stats->pool_capacity);
 }
 
-// SRTF Algorithm (Shortest Remaining Time First) - NEW!
-void srtf(Process processes[], int n, Metrics *metrics) {
-    Process proc[MAX_PROCESSES];
-    reset_processes(processes, proc, n);
+void open_system_menu() {
+    WorkloadSpec spec;
+    if (!read_workload_spec(&spec)) {
+        return;
+    }
+    if (spec.target_utilization >= 1.0) {
+        printf("⚠ An open system has no steady state at 100%% load or more!\n");
+        return;
+    }
 
-    int current_time = 0, completed = 0;
-    int total_burst = 0;
+    OpenConfig config;
+    printf("\nPolicy:\n");
+    printf("1. FCFS\n");
+    printf("2. SJF\n");
+    printf("3. Priority\n");
+    printf("4. Round Robin\n");
+    printf("5. SRTF\n");
+    printf("Choice: ");
+    if (scanf("%d", &config.policy) != 1 || config.policy < OPEN_FCFS || config.policy > OPEN_SRTF) {
+        printf("⚠ Invalid choice!\n");
+        return;
+    }
+    config.quantum = 0;
+    if (config.policy == OPEN_RR) {
+        printf("Time quantum: ");
+        if (scanf("%d", &config.quantum) != 1 || config.quantum <= 0) {
+            printf("⚠ Invalid quantum!\n");
+            return;
+        }
+    }
+
+    double precision;
+    printf("Warmup period (time units): ");
+    if (scanf("%lld", &config.warmup_time) != 1 || config.warmup_time < 0) {
+        printf("⚠ Invalid warmup!\n");
+        return;
+    }
+    printf("Time limit (time units): ");
+    if (scanf("%lld", &config.time_limit) != 1 || config.time_limit <= config.warmup_time) {
+        printf("⚠ Time limit must be after the warmup!\n");
+        return;
+    }
+    printf("Target precision (95%% CI half-width, %% of mean turnaround): ");
+    if (scanf("%lf", &precision) != 1 || precision <= 0) {
+        printf("⚠ Invalid precision!\n");
+        return;
+    }
+    config.target_precision = precision / 100.0;
+    printf("Jobs per batch (batch means): ");
+    if (scanf("%lld", &config.batch_size) != 1 || config.batch_size <= 0) {
+        printf("⚠ Invalid batch size!\n");
+        return;
+    }
+
+    OpenStats stats;
+    clock_t start = clock();
+    bool ok = open_system(&spec, &config, &stats);
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    if (!ok) {
+        printf("⚠ Out of memory after %lld jobs!\n", stats.arrivals);
+    }
+
+    print_open_stats(stdout, &spec, &config, &stats);
+    if (seconds > 0) {
+        printf("Simulation speed:      %.1f M jobs/sec\n", stats.completed / seconds / 1e6);
+    }
+
+    FILE *fp = fopen("scheduling_results.txt", "a");
+    if (fp != NULL) {
+        print_open_stats(fp, &spec, &config, &stats);
+        fclose(fp);
+    }
+}
+
+// Reference (the checkpointing engines) or fast engine for one algorithm
+void oracle_run(int algorithm, bool fast, Process processes[], int n, int quantum, Metrics *metrics) {
+    switch (algorithm) {
+        case ALG_FCFS:
+            fast ? fcfs_fast(processes, n, metrics) : fcfs(processes, n, metrics);
+            break;
+        case ALG_SJF:
+            fast ? sjf_fast(processes, n, metrics) : sjf(processes, n, metrics);
+            break;
+        case ALG_PRIORITY:
+            fast ? priority_fast(processes, n, metrics) : priority_scheduling(processes, n, metrics);
+            break;
+        case ALG_RR:
+            fast ? round_robin_fast(processes, n, quantum, metrics)
+                 : round_robin(processes, n, quantum, metrics);
+            break;
+        case ALG_SRTF:
+            fast ? srtf_fast(processes, n, metrics) : srtf(processes, n, metrics);
+            break;
+        case ALG_MLFQ:
+            fast ? mlfq_fast(processes, n, metrics) : mlfq(processes, n, metrics);
+            break;
+    }
+}
+
+// Random workload for one seed. Ranges are drawn per workload and kept
+// small often, so equal arrivals, bursts and priorities (the tie-break
+// cases) are common
+void oracle_workload(uint64_t seed, Process processes[], int *n, int *quantum) {
+    uint64_t rng = seed * 0x9E3779B97F4A7C15ULL + 0x632BE59BD9B4E019ULL;
+    int max_n[] = {3, 8, 20, MAX_PROCESSES};
+    int arrival_span[] = {1, 6, 30, 300};
+    int burst_span[] = {3, 10, 40};
+    int priority_span[] = {2, 10};
+
+    *n = 1 + (int)(rng_next(&rng) % max_n[rng_next(&rng) % 4]);
+    int arrivals = arrival_span[rng_next(&rng) % 4];
+    int bursts = burst_span[rng_next(&rng) % 3];
+    int priorities = priority_span[rng_next(&rng) % 2];
+    *quantum = 1 + (int)(rng_next(&rng) % 8);
+
+    for (int i = 0; i < *n; i++) {
+        Process *p = &processes[i];
+        memset(p, 0, sizeof(*p));
+        p->pid = i + 1;
+        p->arrival_time = (int)(rng_next(&rng) % arrivals);
+        p->burst_time = 1 + (int)(rng_next(&rng) % bursts);
+        p->priority = 1 + (int)(rng_next(&rng) % priorities);
+        p->proc_class = classify_process(p->burst_time, p->priority);
+        p->width = 1;
+        p->remaining_time = p->burst_time;
+        p->response_time = -1;
+    }
+}
 
+// Run both engines; returns the first diverging output position, n when
+// only the metrics differ, or -1 when they agree
+int oracle_check(int algorithm, const Process workload[], int n, int quantum,
+                 Process reference[], Process fast[]) {
+    Metrics ref_metrics, fast_metrics;
     for (int i = 0; i < n; i++) {
-        total_burst += proc[i].burst_time;
+        reference[i] = workload[i];
+        fast[i] = workload[i];
     }
+    oracle_run(algorithm, false, reference, n, quantum, &ref_metrics);
+    oracle_run(algorithm, true, fast, n, quantum, &fast_metrics);
 
-    while (completed < n) {
-        int idx = -1;
-        int min_remaining = 999999;
+    for (int i = 0; i < n; i++) {
+        if (reference[i].pid != fast[i].pid ||
+            reference[i].completion_time != fast[i].completion_time ||
+            reference[i].waiting_time != fast[i].waiting_time ||
+            reference[i].turnaround_time != fast[i].turnaround_time ||
+            reference[i].response_time != fast[i].response_time) {
+            return i;
+        }
+    }
+    if (ref_metrics.avg_waiting_time != fast_metrics.avg_waiting_time ||
+        ref_metrics.avg_turnaround_time != fast_metrics.avg_turnaround_time ||
+        ref_metrics.avg_response_time != fast_metrics.avg_response_time ||
+        ref_metrics.cpu_utilization != fast_metrics.cpu_utilization ||
+        ref_metrics.throughput != fast_metrics.throughput ||
+        ref_metrics.total_time != fast_metrics.total_time) {
+        return n;
+    }
+    return -1;
+}
 
-        // Find process with shortest remaining time
-        for (int i = 0; i < n; i++) {
-            if (proc[i].arrival_time <= current_time && proc[i].remaining_time > 0) {
-                if (proc[i].remaining_time < min_remaining) {
-                    min_remaining = proc[i].remaining_time;
-                    idx = i;
+// Greedy shrinking: drop processes, then shrink values, keeping any
+// change that still diverges, until nothing more can be removed
+void oracle_minimize(int algorithm, Process workload[], int *n, int *quantum) {
+    Process trial[MAX_PROCESSES], reference[MAX_PROCESSES], fast[MAX_PROCESSES];
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        for (int skip = 0; skip < *n && *n > 1; skip++) {
+            int k = 0;
+            for (int i = 0; i < *n; i++) {
+                if (i != skip) {
+                    trial[k++] = workload[i];
                 }
             }
+            if (oracle_check(algorithm, trial, k, *quantum, reference, fast) != -1) {
+                memcpy(workload, trial, sizeof(Process) * k);
+                *n = k;
+                skip--;
+                changed = true;
+            }
         }
 
-        if (idx != -1) {
-            // Record response time on first execution
-            if (!proc[idx].first_response) {
-                proc[idx].response_time = current_time - proc[idx].arrival_time;
-                proc[idx].first_response = true;
+        for (int i = 0; i < *n; i++) {
+            for (int field = 0; field < 3; field++) {
+                int *value = field == 0 ? &workload[i].arrival_time
+                           : field == 1 ? &workload[i].burst_time : &workload[i].priority;
+                int floor = field == 0 ? 0 : 1;
+                int candidates[3] = {floor, (*value + floor) / 2, *value - 1};
+                for (int c = 0; c < 3; c++) {
+                    if (candidates[c] < floor || candidates[c] >= *value) {
+                        continue;
+                    }
+                    int saved = *value;
+                    *value = candidates[c];
+                    workload[i].remaining_time = workload[i].burst_time;
+                    if (oracle_check(algorithm, workload, *n, *quantum, reference, fast) != -1) {
+                        changed = true;
+                        break;
+                    }
+                    *value = saved;
+                    workload[i].remaining_time = workload[i].burst_time;
+                }
             }
+        }
 
-            proc[idx].remaining_time--;
-            current_time++;
+        if (algorithm == ALG_RR && *quantum > 1) {
+            (*quantum)--;
+            if (oracle_check(algorithm, workload, *n, *quantum, reference, fast) != -1) {
+                changed = true;
+            } else {
+                (*quantum)++;
+            }
+        }
+    }
 
-            if (proc[idx].remaining_time == 0) {
-                proc[idx].completion_time = current_time;
-                proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
-                proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
-                completed++;
+    // Renumber so the reproducer reads P1..Pn
+    for (int i = 0; i < *n; i++) {
+        workload[i].pid = i + 1;
+    }
+}
+
+// Check the workloads for seeds first, first + stride, ... below end
+void oracle_worker(uint64_t first, uint64_t end, uint64_t stride, OracleResult *result) {
+    Process workload[MAX_PROCESSES], reference[MAX_PROCESSES], fast[MAX_PROCESSES];
+    memset(result, 0, sizeof(*result));
+    for (int a = 0; a <= ALG_MLFQ; a++) {
+        result->first_failure[a] = UINT64_MAX;
+    }
+
+    for (uint64_t seed = first; seed < end; seed += stride) {
+        int n, quantum;
+        oracle_workload(seed, workload, &n, &quantum);
+        for (int a = ALG_FCFS; a <= ALG_MLFQ; a++) {
+            if (oracle_check(a, workload, n, quantum, reference, fast) != -1) {
+                result->failures[a]++;
+                if (seed < result->first_failure[a]) {
+                    result->first_failure[a] = seed;
+                }
             }
+        }
+        result->tested++;
+    }
+}
+
+void oracle_report(int algorithm, uint64_t seed) {
+    Process workload[MAX_PROCESSES], reference[MAX_PROCESSES], fast[MAX_PROCESSES];
+    int n, quantum;
+    oracle_workload(seed, workload, &n, &quantum);
+    int original_n = n;
+    oracle_minimize(algorithm, workload, &n, &quantum);
+    int at = oracle_check(algorithm, workload, n, quantum, reference, fast);
+
+    printf("\n⚠ %s diverges: seed %llu, %d processes minimized to %d",
+           algorithm_name(algorithm), (unsigned long long)seed, original_n, n);
+    if (algorithm == ALG_RR) {
+        printf(" (quantum %d)", quantum);
+    }
+    printf("\n");
+    if (at == n) {
+        printf("  Per-process results agree; the metrics differ\n");
+    }
+    printf("  PID  Arr  Burst  Prio | Ref CT  WT  RT | Fast CT  WT  RT\n");
+    for (int i = 0; i < n; i++) {
+        printf("  P%-3d %-4d %-6d %-4d | %6d %3d %3d | %7d %3d %3d%s\n",
+               reference[i].pid, reference[i].arrival_time, reference[i].burst_time,
+               reference[i].priority, reference[i].completion_time, reference[i].waiting_time,
+               reference[i].response_time, fast[i].completion_time, fast[i].waiting_time,
+               fast[i].response_time, i == at ? "  <--" : "");
+    }
+
+    // Loadable with option 13 (output rows may be reordered, the file is not)
+    char filename[64];
+    snprintf(filename, sizeof(filename), "oracle_repro_%s.txt", algorithm_name(algorithm));
+    for (char *c = filename; *c; c++) {
+        if (*c == ' ') {
+            *c = '_';
+        }
+    }
+    FILE *fp = fopen(filename, "w");
+    if (fp != NULL) {
+        fprintf(fp, "# %s: fast engine diverges from reference (seed %llu",
+                algorithm_name(algorithm), (unsigned long long)seed);
+        if (algorithm == ALG_RR) {
+            fprintf(fp, ", quantum %d", quantum);
+        }
+        fprintf(fp, ")\n# arrival burst priority class\n");
+        for (int i = 0; i < n; i++) {
+            fprintf(fp, "%d %d %d %d\n", workload[i].arrival_time, workload[i].burst_time,
+                    workload[i].priority, workload[i].proc_class);
+        }
+        fclose(fp);
+        printf("  Reproducer written to '%s'\n", filename);
+    }
+}
+
+// Differential testing of every fast engine against its reference over
+// count seeded workloads, split across worker processes. Returns the
+// number of diverging workloads.
+long long run_differential_tests(long long count, uint64_t seed, int workers) {
+    OracleResult total;
+    memset(&total, 0, sizeof(total));
+    for (int a = 0; a <= ALG_MLFQ; a++) {
+        total.first_failure[a] = UINT64_MAX;
+    }
+    uint64_t end = seed + (uint64_t)count;
+
+    // Reference engines must not write checkpoints or publish progress
+    int saved_interval = checkpoint_interval;
+    bool saved_monitor = monitor_enabled;
+    checkpoint_interval = 0;
+    monitor_enabled = false;
+
+    printf("\nDifferential oracle: %lld workloads from seed %llu",
+           count, (unsigned long long)seed);
+    fflush(stdout);
+    double start = monotonic_seconds();
+
+#ifdef PARALLEL_SUPPORTED
+    // Engines share globals (counters, progress), so workers are processes
+    if (workers <= 0) {
+        workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (workers < 1) {
+        workers = 1;
+    }
+    if ((long long)workers > count) {
+        workers = count > 0 ? (int)count : 1;
+    }
+    printf(", %d worker%s\n", workers, workers == 1 ? "" : "s");
+
+    int fds[MAX_ORACLE_WORKERS];
+    pid_t pids[MAX_ORACLE_WORKERS];
+    if (workers > MAX_ORACLE_WORKERS) {
+        workers = MAX_ORACLE_WORKERS;
+    }
+    int started = 0;
+    for (int w = 0; w < workers; w++) {
+        int pipefd[2];
+        if (pipe(pipefd) != 0) {
+            break;
+        }
+        pid_t pid = fork();
+        if (pid < 0) {
+            close(pipefd[0]);
+            close(pipefd[1]);
+            break;
+        }
+        if (pid == 0) {
+            close(pipefd[0]);
+            OracleResult result;
+            oracle_worker(seed + w, end, workers, &result);
+            ssize_t written = write(pipefd[1], &result, sizeof(result));
+            _exit(written == (ssize_t)sizeof(result) ? 0 : 1);
+        }
+        close(pipefd[1]);
+        fds[started] = pipefd[0];
+        pids[started] = pid;
+        started++;
+    }
+
+    if (started < workers) {
+        // Could not start them all: check the missing seeds here
+        for (int w = started; w < workers; w++) {
+            OracleResult result;
+            oracle_worker(seed + w, end, workers, &result);
+            oracle_merge(&total, &result);
+        }
+    }
+    for (int w = 0; w < started; w++) {
+        OracleResult result;
+        ssize_t got = read(fds[w], &result, sizeof(result));
+        close(fds[w]);
+        waitpid(pids[w], NULL, 0);
+        if (got == (ssize_t)sizeof(result)) {
+            oracle_merge(&total, &result);
         } else {
-            current_time++;
+            printf("⚠ Worker %d failed\n", w + 1);
         }
     }
+#else
+    (void)workers;
+    printf("\n");
+    oracle_worker(seed, end, 1, &total);
+#endif
+
+    double seconds = monotonic_seconds() - start;
+    long long failing = 0;
+    printf("\n%-14s %12s %12s\n", "Engine", "Workloads", "Divergent");
+    for (int a = ALG_FCFS; a <= ALG_MLFQ; a++) {
+        printf("%-14s %12lld %12lld\n", algorithm_name(a), total.tested, total.failures[a]);
+        failing += total.failures[a];
+    }
+    if (seconds > 0) {
+        printf("Checked %lld workloads in %.1f s (%.0f workloads/sec)\n",
+               total.tested, seconds, total.tested / seconds);
+    }
 
-    calculate_metrics(proc, n, current_time, metrics);
+    for (int a = ALG_FCFS; a <= ALG_MLFQ; a++) {
+        if (total.first_failure[a] != UINT64_MAX) {
+            oracle_report(a, total.first_failure[a]);
+        }
+    }
+    if (failing == 0 && total.tested == count) {
+        printf("✓ All fast engines match their reference engines\n");
+    }
 
-    for (int i = 0; i < n; i++) {
-        processes[i] = proc[i];
+    checkpoint_interval = saved_interval;
+    monitor_enabled = saved_monitor;
+    return failing;
+}
+
+void oracle_merge(OracleResult *total, const OracleResult *result) {
+    total->tested += result->tested;
+    for (int a = ALG_FCFS; a <= ALG_MLFQ; a++) {
+        total->failures[a] += result->failures[a];
+        if (result->first_failure[a] < total->first_failure[a]) {
+            total->first_failure[a] = result->first_failure[a];
+        }
     }
 }
 
-// MLFQ Algorithm (Multi-Level Feedback Queue) - NEW!
-void mlfq(Process processes[], int n, Metrics *metrics) {
-    Process proc[MAX_PROCESSES];
-    reset_processes(processes, proc, n);
+void oracle_menu() {
+    long long count;
+    unsigned long long seed;
+    int workers;
 
-    int quantum[MAX_QUEUES] = {2, 4, 8, 16, 32};
-    int current_time = 0, completed = 0;
+    printf("\nNumber of random workloads: ");
+    if (scanf("%lld", &count) != 1 || count <= 0) {
+        printf("⚠ Invalid count!\n");
+        return;
+    }
+    printf("First seed: ");
+    if (scanf("%llu", &seed) != 1) {
+        printf("⚠ Invalid seed!\n");
+        return;
+    }
+    printf("Worker processes (0 = one per core): ");
+    if (scanf("%d", &workers) != 1 || workers < 0) {
+        printf("⚠ Invalid number of workers!\n");
+        return;
+    }
+    run_differential_tests(count, seed, workers);
+}
 
-    typedef struct {
-        int pid_idx;
-        int queue_level;
-    } QueueItem;
+// Log-linear histogram bucket: exact below LATENCY_SUB_BUCKETS, then
+// LATENCY_SUB_BUCKETS buckets per power of two (about 3% resolution)
+int latency_bucket(long long v) {
+    if (v < LATENCY_SUB_BUCKETS) {
+        return v < 0 ? 0 : (int)v;
+    }
+    int shift = 0;
+    while ((v >> shift) >= 2 * LATENCY_SUB_BUCKETS) {
+        shift++;
+    }
+    int bucket = (shift + 1) * LATENCY_SUB_BUCKETS + (int)((v >> shift) - LATENCY_SUB_BUCKETS);
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
 
-    QueueItem queue[MAX_PROCESSES * MAX_QUEUES];
-    int front = 0, rear = 0;
-    bool in_queue[MAX_PROCESSES] = {false};
+// Lower bound of the values counted in a bucket
+long long latency_bucket_value(int bucket) {
+    if (bucket < LATENCY_SUB_BUCKETS) {
+        return bucket;
+    }
+    int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    return (long long)(LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS) << shift;
+}
 
-    // Initialize all processes to queue level 0
-    for (int i = 0; i < n; i++) {
-        proc[i].queue_level = 0;
+double latency_percentile(const long long hist[], long long count, double pct) {
+    if (count == 0) {
+        return 0.0;
+    }
+    long long rank = (long long)ceil(pct / 100.0 * count);
+    long long seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen >= rank) {
+            return (double)latency_bucket_value(i);
+        }
     }
+    return (double)latency_bucket_value(LATENCY_BUCKETS - 1);
+}
 
-    // Add first arriving process
-    int min_arrival = 999999;
-    int first_idx = 0;
+double monotonic_seconds() {
+#ifdef MONITOR_SUPPORTED
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+long long memory_in_use_kb(bool *is_peak) {
+    *is_peak = false;
+#ifdef MONITOR_SUPPORTED
+    // Resident set size from /proc; only read when a snapshot is sent
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (fp != NULL) {
+        long long pages_total, pages_resident;
+        int fields = fscanf(fp, "%lld %lld", &pages_total, &pages_resident);
+        fclose(fp);
+        if (fields == 2) {
+            return pages_resident * (sysconf(_SC_PAGESIZE) / 1024);
+        }
+    }
+
+    // No /proc (macOS, BSD): getrusage only knows the peak
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        *is_peak = true;
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024;   // Bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+// Socket path in a directory only this user can use: $XDG_RUNTIME_DIR
+// when set, otherwise /tmp/cpu_scheduler-<uid> (mode 0700, created by
+// the viewer). A fixed name in /tmp would let another user bind it first.
+bool monitor_socket_path(char *path, size_t size, bool create) {
+#ifdef MONITOR_SUPPORTED
+    char dir[256];
+    const char *runtime = getenv("XDG_RUNTIME_DIR");
+    if (runtime != NULL && runtime[0] == '/') {
+        snprintf(dir, sizeof(dir), "%s", runtime);
+    } else {
+        snprintf(dir, sizeof(dir), "/tmp/cpu_scheduler-%ld", (long)getuid());
+        if (create && mkdir(dir, 0700) != 0 && errno != EEXIST) {
+            return false;
+        }
+    }
+
+    // Must be a real directory we own that nobody else can write to
+    struct stat info;
+    if (lstat(dir, &info) != 0 || !S_ISDIR(info.st_mode) ||
+        info.st_uid != getuid() || (info.st_mode & 0022) != 0) {
+        return false;
+    }
+    int len = snprintf(path, size, "%s/%s", dir, MONITOR_SOCKET);
+    return len > 0 && (size_t)len < size;
+#else
+    (void)path;
+    (void)size;
+    (void)create;
+    return false;
+#endif
+}
+
+void progress_set_context(const char *context) {
+    snprintf(progress.context, sizeof(progress.context), "%s", context);
+}
+
+void progress_begin(const char *phase, long long total) {
+    if (!monitor_enabled) {
+        return;
+    }
+    progress_reset(phase, total);
+    progress_publish();
+}
+
+void progress_reset(const char *phase, long long total) {
+    if (progress.context[0] != '\0') {
+        snprintf(progress.phase, sizeof(progress.phase), "%s %s", progress.context, phase);
+    } else {
+        snprintf(progress.phase, sizeof(progress.phase), "%s", phase);
+    }
+    progress.total = total;
+    progress.completed = 0;
+    progress.events = 0;
+    progress.sim_time = 0;
+    progress.sum_waiting = 0;
+    progress.sum_turnaround = 0;
+    progress.sum_response = 0;
+    memset(progress.turnaround_hist, 0, sizeof(progress.turnaround_hist));
+    progress.events_at_publish = 0;
+    progress.last_publish = monotonic_seconds();
+}
+
+// Never blocks: the socket is non-blocking and a snapshot that cannot be
+// delivered (no monitor attached, or its buffer is full) is dropped
+void progress_publish() {
+#ifdef MONITOR_SUPPORTED
+    if (progress.fd < 0) {
+        progress.fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (progress.fd < 0) {
+            return;
+        }
+        fcntl(progress.fd, F_SETFL, fcntl(progress.fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    double now = monotonic_seconds();
+    double elapsed = now - progress.last_publish;
+    long long count = progress.completed;
+
+    ProgressSnapshot snap;
+    memset(&snap, 0, sizeof(snap));
+    snap.magic = MONITOR_MAGIC;
+    snprintf(snap.phase, sizeof(snap.phase), "%s", progress.phase);
+    snap.sim_time = progress.sim_time;
+    snap.completed = count;
+    snap.total = progress.total;
+    if (count > 0) {
+        snap.avg_waiting = progress.sum_waiting / count;
+        snap.avg_turnaround = progress.sum_turnaround / count;
+        snap.avg_response = progress.sum_response / count;
+    }
+    snap.p50_turnaround = latency_percentile(progress.turnaround_hist, count, 50.0);
+    snap.p95_turnaround = latency_percentile(progress.turnaround_hist, count, 95.0);
+    snap.p99_turnaround = latency_percentile(progress.turnaround_hist, count, 99.0);
+    if (elapsed > 0) {
+        snap.events_per_sec = (progress.events - progress.events_at_publish) / elapsed;
+    }
+    bool is_peak;
+    snap.memory_kb = memory_in_use_kb(&is_peak);
+    snap.memory_is_peak = is_peak;
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (monitor_socket_path(addr.sun_path, sizeof(addr.sun_path), false)) {
+        sendto(progress.fd, &snap, sizeof(snap), MSG_DONTWAIT,
+               (struct sockaddr *)&addr, sizeof(addr));
+    }
+
+    progress.events_at_publish = progress.events;
+    progress.last_publish = now;
+#endif
+}
+
+// Rate-limited: the clock is only read every PROGRESS_CHECK_EVENTS events
+void progress_maybe_publish() {
+    if (progress.events % PROGRESS_CHECK_EVENTS != 0) {
+        return;
+    }
+    if ((monotonic_seconds() - progress.last_publish) * 1000.0 >= MONITOR_INTERVAL_MS) {
+        progress_publish();
+    }
+}
+
+void progress_add(const Process *p) {
+    progress.completed++;
+    if (p->completion_time > progress.sim_time) {
+        progress.sim_time = p->completion_time;
+    }
+    progress.sum_waiting += p->waiting_time;
+    progress.sum_turnaround += p->turnaround_time;
+    progress.sum_response += p->response_time;
+    progress.turnaround_hist[latency_bucket(p->turnaround_time)]++;
+}
+
+void progress_complete(const Process *p) {
+    progress.events++;
+    progress_add(p);
+    progress_maybe_publish();
+}
+
+// A resumed run starts from the processes its checkpoint had finished
+void progress_restore(const char *phase, const Process proc[], int n) {
+    if (!monitor_enabled) {
+        return;
+    }
+    progress_reset(phase, n);
     for (int i = 0; i < n; i++) {
-        if (proc[i].arrival_time < min_arrival) {
-            min_arrival = proc[i].arrival_time;
-            first_idx = i;
+        if (proc[i].completion_time > 0) {
+            progress_add(&proc[i]);
         }
     }
+    progress_publish();
+}
+
+// For producers without per-process metrics (e.g. trace import)
+void progress_tick(long long completed, long long sim_time) {
+    progress.events++;
+    progress.completed = completed;
+    progress.sim_time = sim_time;
+    progress_maybe_publish();
+}
+
+void progress_end() {
+    if (monitor_enabled) {
+        progress_publish();
+    }
+}
+
+void toggle_monitor() {
+#ifdef MONITOR_SUPPORTED
+    monitor_enabled = !monitor_enabled;
+    if (monitor_enabled) {
+        printf("✓ Live monitor publishing enabled\n");
+        printf("  Attach a viewer with: ./cpu_scheduler --monitor\n");
+    } else {
+        printf("✓ Live monitor publishing disabled\n");
+    }
+#else
+    printf("⚠ Live monitor is not supported on this platform!\n");
+#endif
+}
 
-    current_time = proc[first_idx].arrival_time;
-    queue[rear].pid_idx = first_idx;
-    queue[rear].queue_level = 0;
-    rear++;
-    in_queue[first_idx] = true;
+// Viewer: ./cpu_scheduler --monitor
+int monitor_main() {
+#ifdef MONITOR_SUPPORTED
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        printf("⚠ Could not create monitor socket!\n");
+        return 1;
+    }
 
-    while (completed < n) {
-        if (front == rear) {
-            int next_arrival = 999999;
-            int next_idx = -1;
-            for (int i = 0; i < n; i++) {
-                if (proc[i].remaining_time > 0 && proc[i].arrival_time > current_time) {
-                    if (proc[i].arrival_time < next_arrival) {
-                        next_arrival = proc[i].arrival_time;
-                        next_idx = i;
-                    }
-                }
-            }
-            if (next_idx != -1) {
-                current_time = proc[next_idx].arrival_time;
-                queue[rear].pid_idx = next_idx;
-                queue[rear].queue_level = proc[next_idx].queue_level;
-                rear++;
-                in_queue[next_idx] = true;
-            }
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (!monitor_socket_path(addr.sun_path, sizeof(addr.sun_path), true)) {
+        printf("⚠ No private directory for the monitor socket!\n");
+        close(fd);
+        return 1;
+    }
+    unlink(addr.sun_path);   // Stale socket from an earlier viewer
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        printf("⚠ Could not bind '%s'!\n", addr.sun_path);
+        close(fd);
+        return 1;
+    }
+
+    printf("Waiting for simulator snapshots on %s (Ctrl+C to quit)...\n", addr.sun_path);
+
+    ProgressSnapshot snap;
+    for (;;) {
+        ssize_t len = recv(fd, &snap, sizeof(snap), 0);
+        if (len != (ssize_t)sizeof(snap) || snap.magic != MONITOR_MAGIC) {
             continue;
         }
 
-        // Find highest priority (lowest queue level) process
-        int selected_idx = front;
-        for (int i = front; i < rear; i++) {
-            if (queue[i].queue_level < queue[selected_idx].queue_level) {
-                selected_idx = i;
-            }
+        printf("\033[H\033[J");
+        printf("╔════════════════════════════════════════════════════════════╗\n");
+        printf("║          CPU SCHEDULER LIVE MONITOR (Ctrl+C to quit)       ║\n");
+        printf("╠════════════════════════════════════════════════════════════╣\n");
+        printf("║  Phase:                 %s\n", snap.phase);
+        printf("║  Simulated Time:        %lld time units\n", snap.sim_time);
+        if (snap.total > 0) {
+            printf("║  Completed:             %lld / %lld (%.1f%%)\n", snap.completed, snap.total,
+                   100.0 * snap.completed / snap.total);
+        } else {
+            printf("║  Completed:             %lld\n", snap.completed);
+        }
+        printf("║  Average Waiting:       %.2f\n", snap.avg_waiting);
+        printf("║  Average Turnaround:    %.2f\n", snap.avg_turnaround);
+        printf("║  Average Response:      %.2f\n", snap.avg_response);
+        printf("║  Turnaround p50/p95/p99: %.0f / %.0f / %.0f\n",
+               snap.p50_turnaround, snap.p95_turnaround, snap.p99_turnaround);
+        printf("║  Events/sec:            %.0f\n", snap.events_per_sec);
+        if (snap.memory_is_peak) {
+            printf("║  Peak Memory:           %lld KB\n", snap.memory_kb);
+        } else {
+            printf("║  Memory In Use:         %lld KB\n", snap.memory_kb);
         }
+        printf("╚════════════════════════════════════════════════════════════╝\n");
+        fflush(stdout);
+    }
+#else
+    printf("⚠ Live monitor is not supported on this platform!\n");
+    return 1;
+#endif
+}
 
-        QueueItem current = queue[selected_idx];
-        // Remove from queue by shifting
-        for (int i = selected_idx; i < rear - 1; i++) {
-            queue[i] = queue[i + 1];
+#ifdef SCHED_INSTRUMENT
+#ifdef SCHED_PERF
+// Hardware counter group, opened once on first use (-1 = unavailable)
+int perf_fds[4] = {-1, -1, -1, -1};
+bool perf_opened = false;
+
+void perf_open() {
+    static const unsigned long long configs[4] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    perf_opened = true;
+    for (int i = 0; i < 4; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = configs[i];
+        attr.disabled = (i == 0);   // Leader starts the whole group
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+
+        perf_fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1,
+                                   i == 0 ? -1 : perf_fds[0], 0);
+        if (perf_fds[i] < 0) {
+            // All or nothing: a partial group would mislead
+            for (int j = 0; j < i; j++) {
+                close(perf_fds[j]);
+                perf_fds[j] = -1;
+            }
+            perf_fds[i] = -1;
+            return;
         }
-        rear--;
+    }
+}
+#endif
 
-        int idx = current.pid_idx;
-        int level = proc[idx].queue_level;
+void instr_begin() {
+    memset(&counters, 0, sizeof(counters));
+#ifdef SCHED_PERF
+    if (!perf_opened) {
+        perf_open();
+    }
+    if (perf_fds[0] >= 0) {
+        ioctl(perf_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(perf_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
 
-        if (proc[idx].remaining_time > 0) {
-            if (!proc[idx].first_response) {
-                proc[idx].response_time = current_time - proc[idx].arrival_time;
-                proc[idx].first_response = true;
-            }
+void instr_end() {
+#ifdef SCHED_PERF
+    if (perf_fds[0] >= 0) {
+        ioctl(perf_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // PERF_FORMAT_GROUP layout: nr, then one value per event
+        unsigned long long values[1 + 4];
+        if (read(perf_fds[0], values, sizeof(values)) == (ssize_t)sizeof(values) && values[0] == 4) {
+            counters.cycles = (long long)values[1];
+            counters.instructions = (long long)values[2];
+            counters.cache_misses = (long long)values[3];
+            counters.branch_misses = (long long)values[4];
+            counters.hw_valid = true;
+        }
+    }
+#endif
+}
 
-            int time_quantum = quantum[level];
-            int exec_time = (proc[idx].remaining_time > time_quantum) ? time_quantum : proc[idx].remaining_time;
-            proc[idx].remaining_time -= exec_time;
-            current_time += exec_time;
+void instr_ready(int length, long long duration) {
+    if (length > counters.max_ready) {
+        counters.max_ready = length;
+    }
+    int bucket = length < READY_HIST_BUCKETS - 1 ? length : READY_HIST_BUCKETS - 1;
+    counters.ready_time[bucket] += duration;
+}
 
-            // Add newly arrived processes
-            for (int i = 0; i < n; i++) {
-                if (proc[i].arrival_time <= current_time && proc[i].remaining_time > 0 && !in_queue[i]) {
-                    queue[rear].pid_idx = i;
-                    queue[rear].queue_level = proc[i].queue_level;
-                    rear++;
-                    in_queue[i] = true;
-                }
-            }
+void print_counters(FILE *fp) {
+    long long total = 0;
+    for (int i = 0; i < READY_HIST_BUCKETS; i++) {
+        total += counters.ready_time[i];
+    }
 
-            if (proc[idx].remaining_time == 0) {
-                proc[idx].completion_time = current_time;
-                proc[idx].turnaround_time = proc[idx].completion_time - proc[idx].arrival_time;
-                proc[idx].waiting_time = proc[idx].turnaround_time - proc[idx].burst_time;
-                completed++;
-                in_queue[idx] = false;
-            } else {
-                // Move to lower priority queue if not completed
-                if (proc[idx].queue_level < MAX_QUEUES - 1) {
-                    proc[idx].queue_level++;
-                }
-                queue[rear].pid_idx = idx;
-                queue[rear].queue_level = proc[idx].queue_level;
-                rear++;
-            }
+    fprintf(fp, "\nEngine Counters:\n");
+    fprintf(fp, "--------------------------------------------------------------------\n");
+    fprintf(fp, "Dispatches:                %lld\n", counters.dispatches);
+    fprintf(fp, "Preemptions:               %lld\n", counters.preemptions);
+    fprintf(fp, "Queue Scan Steps:          %lld\n", counters.queue_scans);
+    fprintf(fp, "Heap Operations:           %lld\n", counters.heap_ops);
+    fprintf(fp, "Max Ready Queue Length:    %d\n", counters.max_ready);
+    if (counters.hw_valid) {
+        fprintf(fp, "Cycles:                    %lld\n", counters.cycles);
+        fprintf(fp, "Instructions:              %lld\n", counters.instructions);
+        fprintf(fp, "Cache Misses:              %lld\n", counters.cache_misses);
+        fprintf(fp, "Branch Misses:             %lld\n", counters.branch_misses);
+    }
+
+    fprintf(fp, "Ready Queue Length (share of simulated time):\n");
+    for (int i = 0; i < READY_HIST_BUCKETS; i++) {
+        if (counters.ready_time[i] == 0 || total == 0) {
+            continue;
         }
+        fprintf(fp, "  %2d%s  %6.2f%%\n", i, i == READY_HIST_BUCKETS - 1 ? "+" : " ",
+                100.0 * counters.ready_time[i] / total);
     }
+}
 
-    calculate_metrics(proc, n, current_time, metrics);
+void write_counters_csv_header(FILE *fp) {
+    fprintf(fp, ",Dispatches,Preemptions,Queue Scans,Heap Ops,Max Ready,"
+                "Cycles,Instructions,Cache Misses,Branch Misses");
+}
 
-    for (int i = 0; i < n; i++) {
-        processes[i] = proc[i];
+void write_counters_csv(FILE *fp) {
+    fprintf(fp, ",%lld,%lld,%lld,%lld,%d", counters.dispatches, counters.preemptions,
+            counters.queue_scans, counters.heap_ops, counters.max_ready);
+    if (counters.hw_valid) {
+        fprintf(fp, ",%lld,%lld,%lld,%lld", counters.cycles, counters.instructions,
+                counters.cache_misses, counters.branch_misses);
+    } else {
+        fprintf(fp, ",,,,");
     }
 }
+#endif
 
 void calculate_metrics(Process processes[], int n, int total_time, Metrics *metrics) {
     double total_waiting = 0, total_turnaround = 0, total_response = 0;
@@ -691,28 +5847,33 @@ void calculate_metrics(Process processes[], int n, int total_time, Metrics *metr
     metrics->total_time = total_time;
 }
 
+// processes may be NULL for a metrics-only cache hit
 void print_results(Process processes[], int n, Metrics metrics, const char *algorithm) {
     printf("\n");
     printf("╔════════════════════════════════════════════════════════════╗\n");
     printf("║              %s SCHEDULING RESULTS                    \n", algorithm);
     printf("╚════════════════════════════════════════════════════════════╝\n\n");
 
-    printf("┌─────┬─────────┬──────────┬──────────┬────────────┬───────────┬──────────┐\n");
-    printf("│ PID │ Arrival │ Burst    │ Priority │ Waiting    │ Turnaround│ Response │\n");
-    printf("├─────┼─────────┼──────────┼──────────┼────────────┼───────────┼──────────┤\n");
+    if (processes == NULL) {
+        printf("Per-process results not cached (metrics-only entry)\n\n");
+    } else {
+        printf("┌─────┬─────────┬──────────┬──────────┬────────────┬───────────┬──────────┐\n");
+        printf("│ PID │ Arrival │ Burst    │ Priority │ Waiting    │ Turnaround│ Response │\n");
+        printf("├─────┼─────────┼──────────┼──────────┼────────────┼───────────┼──────────┤\n");
 
-    for (int i = 0; i < n; i++) {
-        printf("│ P%-3d│   %-6d│   %-7d│    %-6d│    %-8d│    %-7d│   %-7d│\n",
-               processes[i].pid,
-               processes[i].arrival_time,
-               processes[i].burst_time,
-               processes[i].priority,
-               processes[i].waiting_time,
-               processes[i].turnaround_time,
-               processes[i].response_time);
-    }
+        for (int i = 0; i < n; i++) {
+            printf("│ P%-3d│   %-6d│   %-7d│    %-6d│    %-8d│    %-7d│   %-7d│\n",
+                   processes[i].pid,
+                   processes[i].arrival_time,
+                   processes[i].burst_time,
+                   processes[i].priority,
+                   processes[i].waiting_time,
+                   processes[i].turnaround_time,
+                   processes[i].response_time);
+        }
 
-    printf("└─────┴─────────┴──────────┴──────────┴────────────┴───────────┴──────────┘\n\n");
+        printf("└─────┴─────────┴──────────┴──────────┴────────────┴───────────┴──────────┘\n\n");
+    }
 
     printf("╔════════════════════════════════════════════════════════════╗\n");
     printf("║                   PERFORMANCE METRICS                      ║\n");
@@ -724,8 +5885,10 @@ void print_results(Process processes[], int n, Metrics metrics, const char *algo
     printf("║  Throughput:                  %.4f processes/unit      \n", metrics.throughput);
     printf("║  Total Execution Time:        %d time units            \n", metrics.total_time);
     printf("╚════════════════════════════════════════════════════════════╝\n");
+    INSTR_PRINT(stdout);
 }
 
+// processes may be NULL for a metrics-only cache hit
 void save_to_file(Process processes[], int n, Metrics metrics, const char *algorithm) {
     FILE *fp = fopen("scheduling_results.txt", "a");
     if (fp == NULL) {
@@ -742,19 +5905,23 @@ void save_to_file(Process processes[], int n, Metrics metrics, const char *algor
     fprintf(fp, "Number of Processes: %d\n", n);
     fprintf(fp, "========================================\n\n");
 
-    fprintf(fp, "Process Details:\n");
-    fprintf(fp, "PID\tArrival\tBurst\tPriority\tWaiting\tTurnaround\tResponse\n");
-    fprintf(fp, "--------------------------------------------------------------------\n");
+    if (processes == NULL) {
+        fprintf(fp, "Process Details: not cached (metrics-only entry)\n");
+    } else {
+        fprintf(fp, "Process Details:\n");
+        fprintf(fp, "PID\tArrival\tBurst\tPriority\tWaiting\tTurnaround\tResponse\n");
+        fprintf(fp, "--------------------------------------------------------------------\n");
 
-    for (int i = 0; i < n; i++) {
-        fprintf(fp, "P%d\t%d\t%d\t%d\t\t%d\t%d\t\t%d\n",
-                processes[i].pid,
-                processes[i].arrival_time,
-                processes[i].burst_time,
-                processes[i].priority,
-                processes[i].waiting_time,
-                processes[i].turnaround_time,
-                processes[i].response_time);
+        for (int i = 0; i < n; i++) {
+            fprintf(fp, "P%d\t%d\t%d\t%d\t\t%d\t%d\t\t%d\n",
+                    processes[i].pid,
+                    processes[i].arrival_time,
+                    processes[i].burst_time,
+                    processes[i].priority,
+                    processes[i].waiting_time,
+                    processes[i].turnaround_time,
+                    processes[i].response_time);
+        }
     }
 
     fprintf(fp, "\nPerformance Metrics:\n");
@@ -765,11 +5932,25 @@ void save_to_file(Process processes[], int n, Metrics metrics, const char *algor
     fprintf(fp, "CPU Utilization:           %.2f%%\n", metrics.cpu_utilization);
     fprintf(fp, "Throughput:                %.4f processes/unit\n", metrics.throughput);
     fprintf(fp, "Total Execution Time:      %d time units\n", metrics.total_time);
+    INSTR_PRINT(fp);
     fprintf(fp, "\n\n");
 
     fclose(fp);
 }
 
+void write_comparison_row(FILE *fp, const char *test_name, int workload,
+                          const char *algorithm, Metrics metrics) {
+    if (fp == NULL) {
+        return;
+    }
+    fprintf(fp, "%s-%d,%s,%.2f,%.2f,%.2f,%.2f,%.4f",
+            test_name, workload, algorithm, metrics.avg_waiting_time,
+            metrics.avg_turnaround_time, metrics.avg_response_time,
+            metrics.cpu_utilization, metrics.throughput);
+    INSTR_CSV(fp);
+    fprintf(fp, "\n");
+}
+
 void run_comprehensive_tests() {
     printf("\n");
     printf("╔════════════════════════════════════════════════════════════╗\n");
@@ -788,10 +5969,17 @@ void run_comprehensive_tests() {
     // Open comparison file
     FILE *comp_fp = fopen("algorithm_comparison.csv", "w");
     if (comp_fp != NULL) {
-        fprintf(comp_fp, "Test Name,Algorithm,Avg Waiting,Avg Turnaround,Avg Response,CPU Util,Throughput\n");
+        fprintf(comp_fp, "Test Name,Algorithm,Avg Waiting,Avg Turnaround,Avg Response,CPU Util,Throughput");
+        INSTR_CSV_HEADER(comp_fp);
+        fprintf(comp_fp, "\n");
     }
 
     Process test_processes[MAX_PROCESSES];
+    MLQConfig mlq_config;
+    Metrics class_metrics[NUM_CLASSES];
+    int class_counts[NUM_CLASSES];
+    mlq_default_config(&mlq_config);
+
     int test_sizes[] = {5, 10, 20, 50};
     char *test_names[] = {"Small", "Medium", "Large", "XLarge"};
     int num_tests = 4;
@@ -816,7 +6004,12 @@ void run_comprehensive_tests() {
             }
             printf("└────────────────────────────────────────────────────────┘\n");
 
-            generate_test_workload(test_processes, &n, workload);
+            // Fixed seeds, so a rerun sees the same workloads and hits the cache
+            fill_test_workload(test_processes, n, workload, TEST_WORKLOAD_SEED + test * 3 + workload);
+
+            char context[32];
+            snprintf(context, sizeof(context), "%s-%d", test_names[test], workload);
+            progress_set_context(context);
 
             // Save test data
             FILE *test_fp = fopen("scheduling_results.txt", "a");
@@ -830,86 +6023,76 @@ void run_comprehensive_tests() {
                 fclose(test_fp);
             }
 
-            // Test all algorithms
+            // Test all algorithms. Each run is looked up in the result cache
+            // first; a workload seen before is loaded instead of simulated
             Metrics metrics;
             Process proc_copy[MAX_PROCESSES];
+            Process *results;
 
             // FCFS
             printf("  Testing FCFS... ");
             reset_processes(test_processes, proc_copy, n);
-            fcfs(proc_copy, n, &metrics);
-            save_to_file(proc_copy, n, metrics, "FCFS");
-            if (comp_fp != NULL) {
-                fprintf(comp_fp, "%s-%d,FCFS,%.2f,%.2f,%.2f,%.2f,%.4f\n",
-                        test_names[test], workload, metrics.avg_waiting_time,
-                        metrics.avg_turnaround_time, metrics.avg_response_time,
-                        metrics.cpu_utilization, metrics.throughput);
-            }
+            results = cached_output(run_cached(ALG_FCFS, proc_copy, n, 0, &metrics), proc_copy);
+            save_to_file(results, n, metrics, "FCFS");
+            write_comparison_row(comp_fp, test_names[test], workload, "FCFS", metrics);
             printf("✓\n");
 
             // SJF
             printf("  Testing SJF... ");
             reset_processes(test_processes, proc_copy, n);
-            sjf(proc_copy, n, &metrics);
-            save_to_file(proc_copy, n, metrics, "SJF");
-            if (comp_fp != NULL) {
-                fprintf(comp_fp, "%s-%d,SJF,%.2f,%.2f,%.2f,%.2f,%.4f\n",
-                        test_names[test], workload, metrics.avg_waiting_time,
-                        metrics.avg_turnaround_time, metrics.avg_response_time,
-                        metrics.cpu_utilization, metrics.throughput);
-            }
+            results = cached_output(run_cached(ALG_SJF, proc_copy, n, 0, &metrics), proc_copy);
+            save_to_file(results, n, metrics, "SJF");
+            write_comparison_row(comp_fp, test_names[test], workload, "SJF", metrics);
             printf("✓\n");
 
             // Priority
             printf("  Testing Priority... ");
             reset_processes(test_processes, proc_copy, n);
-            priority_scheduling(proc_copy, n, &metrics);
-            save_to_file(proc_copy, n, metrics, "Priority");
-            if (comp_fp != NULL) {
-                fprintf(comp_fp, "%s-%d,Priority,%.2f,%.2f,%.2f,%.2f,%.4f\n",
-                        test_names[test], workload, metrics.avg_waiting_time,
-                        metrics.avg_turnaround_time, metrics.avg_response_time,
-                        metrics.cpu_utilization, metrics.throughput);
-            }
+            results = cached_output(run_cached(ALG_PRIORITY, proc_copy, n, 0, &metrics), proc_copy);
+            save_to_file(results, n, metrics, "Priority");
+            write_comparison_row(comp_fp, test_names[test], workload, "Priority", metrics);
             printf("✓\n");
 
             // Round Robin
             printf("  Testing Round Robin... ");
             reset_processes(test_processes, proc_copy, n);
-            round_robin(proc_copy, n, 4, &metrics);
-            save_to_file(proc_copy, n, metrics, "Round Robin (q=4)");
-            if (comp_fp != NULL) {
-                fprintf(comp_fp, "%s-%d,RR(q=4),%.2f,%.2f,%.2f,%.2f,%.4f\n",
-                        test_names[test], workload, metrics.avg_waiting_time,
-                        metrics.avg_turnaround_time, metrics.avg_response_time,
-                        metrics.cpu_utilization, metrics.throughput);
-            }
+            results = cached_output(run_cached(ALG_RR, proc_copy, n, 4, &metrics), proc_copy);
+            save_to_file(results, n, metrics, "Round Robin (q=4)");
+            write_comparison_row(comp_fp, test_names[test], workload, "RR(q=4)", metrics);
             printf("✓\n");
 
             // SRTF
             printf("  Testing SRTF... ");
             reset_processes(test_processes, proc_copy, n);
-            srtf(proc_copy, n, &metrics);
-            save_to_file(proc_copy, n, metrics, "SRTF");
-            if (comp_fp != NULL) {
-                fprintf(comp_fp, "%s-%d,SRTF,%.2f,%.2f,%.2f,%.2f,%.4f\n",
-                        test_names[test], workload, metrics.avg_waiting_time,
-                        metrics.avg_turnaround_time, metrics.avg_response_time,
-                        metrics.cpu_utilization, metrics.throughput);
-            }
+            results = cached_output(run_cached(ALG_SRTF, proc_copy, n, 0, &metrics), proc_copy);
+            save_to_file(results, n, metrics, "SRTF");
+            write_comparison_row(comp_fp, test_names[test], workload, "SRTF", metrics);
             printf("✓\n");
 
             // MLFQ
             printf("  Testing MLFQ... ");
             reset_processes(test_processes, proc_copy, n);
-            mlfq(proc_copy, n, &metrics);
-            save_to_file(proc_copy, n, metrics, "MLFQ");
-            if (comp_fp != NULL) {
-                fprintf(comp_fp, "%s-%d,MLFQ,%.2f,%.2f,%.2f,%.2f,%.4f\n",
-                        test_names[test], workload, metrics.avg_waiting_time,
-                        metrics.avg_turnaround_time, metrics.avg_response_time,
-                        metrics.cpu_utilization, metrics.throughput);
-            }
+            results = cached_output(run_cached(ALG_MLFQ, proc_copy, n, 0, &metrics), proc_copy);
+            save_to_file(results, n, metrics, "MLFQ");
+            write_comparison_row(comp_fp, test_names[test], workload, "MLFQ", metrics);
+            printf("✓\n");
+
+            // Preemptive Priority with aging
+            printf("  Testing Preemptive Priority... ");
+            reset_processes(test_processes, proc_copy, n);
+            results = cached_output(priority_preemptive_cached(proc_copy, n, 10, &metrics), proc_copy);
+            save_to_file(results, n, metrics, "Preemptive Priority (aging=10)");
+            write_comparison_row(comp_fp, test_names[test], workload, "PPrio(age=10)", metrics);
+            printf("✓\n");
+
+            // Multilevel Queue (default classes, weighted shares)
+            printf("  Testing Multilevel Queue... ");
+            reset_processes(test_processes, proc_copy, n);
+            results = cached_output(mlq_cached(proc_copy, n, &mlq_config, &metrics,
+                                               class_metrics, class_counts), proc_copy);
+            save_to_file(results, n, metrics, "Multilevel Queue (weighted)");
+            save_class_metrics(&mlq_config, class_metrics, class_counts);
+            write_comparison_row(comp_fp, test_names[test], workload, "MLQ(weighted)", metrics);
             printf("✓\n");
         }
     }
@@ -917,6 +6100,7 @@ void run_comprehensive_tests() {
     if (comp_fp != NULL) {
         fclose(comp_fp);
     }
+    progress_set_context("");
 
     printf("\n");
     printf("╔════════════════════════════════════════════════════════════╗\n");
@@ -926,4 +6110,549 @@ void run_comprehensive_tests() {
     printf("║    • scheduling_results.txt (Detailed results)             ║\n");
     printf("║    • algorithm_comparison.csv (Comparison table)           ║\n");
     printf("╚════════════════════════════════════════════════════════════╝\n");
-}
\ No newline at end of file
+    if (cache_enabled) {
+        printf("\n");
+        print_cache_report(stdout);
+    }
+}
+
+const char *gang_policy_name(int policy) {
+    switch (policy) {
+        case GANG_FCFS:      return "Gang FCFS";
+        case GANG_EASY:      return "EASY Backfill";
+        case GANG_FIRST_FIT: return "First-Fit";
+        default:             return "Unknown";
+    }
+}
+
+bool tree_init(MinTree *t, int count) {
+    t->size = 1;
+    while (t->size < count) {
+        t->size *= 2;
+    }
+    t->value = malloc(sizeof(long long) * 2 * t->size);
+    if (t->value == NULL) {
+        return false;
+    }
+    for (int i = 0; i < 2 * t->size; i++) {
+        t->value[i] = LLONG_MAX;
+    }
+    return true;
+}
+
+void tree_set(MinTree *t, int pos, long long value) {
+    int i = pos + t->size;
+    t->value[i] = value;
+    for (i /= 2; i >= 1; i /= 2) {
+        long long l = t->value[2 * i], r = t->value[2 * i + 1];
+        t->value[i] = l < r ? l : r;
+    }
+}
+
+// Leftmost position holding a value <= limit, or -1
+int tree_leftmost(const MinTree *t, long long limit) {
+    if (t->value[1] > limit) {
+        return -1;
+    }
+    int i = 1;
+    while (i < t->size) {
+        i = t->value[2 * i] <= limit ? 2 * i : 2 * i + 1;
+    }
+    return i - t->size;
+}
+
+int compare_gang_jobs(const void *a, const void *b) {
+    const GangJob *x = a, *y = b;
+    if (x->arrival != y->arrival) {
+        return x->arrival < y->arrival ? -1 : 1;
+    }
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+// Earliest-queued waiting job that can start now: width <= free, and
+// runtime <= short_limit unless width <= wide_ok (EASY: jobs that end
+// before the shadow time, or that fit in the extra CPUs). One query per
+// width bucket instead of a queue scan
+int gang_pick(GangScheduler *g, int free, long long short_limit, int wide_ok) {
+    int best = -1;
+    for (int b = 0; b < g->bucket_count && g->buckets[b].width <= free; b++) {
+        GangBucket *bucket = &g->buckets[b];
+        long long limit = bucket->width <= wide_ok ? LLONG_MAX - 1 : short_limit;
+        int pos = tree_leftmost(&bucket->tree, limit);
+        if (pos != -1 && (best == -1 || bucket->jobs[pos] < best)) {
+            best = bucket->jobs[pos];
+        }
+    }
+    return best;
+}
+
+void gang_start(GangScheduler *g, int j, long long now) {
+    GangJob *job = &g->jobs[j];
+    GangBucket *bucket = &g->buckets[job->bucket];
+    INSTR_DISPATCH();
+    tree_set(&bucket->tree, job->slot, LLONG_MAX);
+    job->start = now;
+    job->end = now + job->runtime;
+    g->free -= job->width;
+    g->waiting--;
+
+    // Running set sorted by end time, latest first, so the next
+    // completion is at the back
+    int lo = 0, hi = g->running_count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (g->running[mid].end >= job->end) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    memmove(&g->running[lo + 1], &g->running[lo],
+            sizeof(RunningJob) * (g->running_count - lo));
+    g->running[lo].end = job->end;
+    g->running[lo].width = job->width;
+    g->running[lo].job = j;
+    g->running_count++;
+}
+
+void gang_schedule(GangScheduler *g, int policy, long long now, GangStats *stats) {
+    // First-fit: earliest-queued job that fits, repeatedly
+    if (policy == GANG_FIRST_FIT) {
+        int j;
+        while ((j = gang_pick(g, g->free, LLONG_MAX - 1, g->free)) != -1) {
+            if (j != g->head) {
+                stats->backfilled++;
+            }
+            gang_start(g, j, now);
+            while (g->head < g->arrived && g->jobs[g->head].start >= 0) {
+                g->head++;
+            }
+        }
+        return;
+    }
+
+    // Strict FCFS from the head of the queue
+    while (g->head < g->arrived && g->jobs[g->head].width <= g->free) {
+        gang_start(g, g->head, now);
+        do {
+            g->head++;
+        } while (g->head < g->arrived && g->jobs[g->head].start >= 0);
+    }
+    if (policy != GANG_EASY || g->head >= g->arrived) {
+        return;
+    }
+
+    // EASY: reserve the head's start (shadow time) from the sorted end
+    // times, then backfill jobs that do not delay that reservation. Every
+    // job ending at the shadow time counts towards the extra CPUs
+    int need = g->jobs[g->head].width;
+    int avail = g->free;
+    long long shadow = now;
+    int r = g->running_count - 1;
+    while (r >= 0 && (avail < need || g->running[r].end == shadow)) {
+        avail += g->running[r].width;
+        shadow = g->running[r].end;
+        r--;
+    }
+    int extra = avail - need;
+
+    int j;
+    while ((j = gang_pick(g, g->free, shadow - now, extra)) != -1) {
+        if (now + g->jobs[j].runtime > shadow) {
+            extra -= g->jobs[j].width;
+        }
+        stats->backfilled++;
+        gang_start(g, j, now);
+    }
+}
+
+// Gang / Batch Scheduling of parallel jobs - NEW!
+// Each job needs width CPUs at once for its whole runtime (all-or-nothing
+// co-allocation, no time slicing). Runtimes double as exact user
+// estimates for EASY. jobs[] is sorted by arrival in place.
+bool gang_simulate(GangJob jobs[], int n, int cpus, int policy, GangStats *stats) {
+    INSTR_BEGIN();
+    memset(stats, 0, sizeof(*stats));
+    qsort(jobs, n, sizeof(GangJob), compare_gang_jobs);
+
+    GangScheduler g;
+    memset(&g, 0, sizeof(g));
+    g.jobs = jobs;
+    g.free = cpus;
+    g.running = malloc(sizeof(RunningJob) * (cpus + 1));
+    int *width_count = calloc(cpus + 1, sizeof(int));
+    bool ok = g.running != NULL && width_count != NULL;
+
+    // One bucket per distinct width, positions in queue order
+    for (int j = 0; ok && j < n; j++) {
+        if (jobs[j].width < 1 || jobs[j].width > cpus) {
+            ok = false;
+            break;
+        }
+        width_count[jobs[j].width]++;
+        jobs[j].start = -1;
+        jobs[j].end = -1;
+    }
+    if (ok) {
+        for (int w = 1; w <= cpus; w++) {
+            if (width_count[w] > 0) {
+                g.bucket_count++;
+            }
+        }
+        g.buckets = calloc(g.bucket_count > 0 ? g.bucket_count : 1, sizeof(GangBucket));
+        ok = g.buckets != NULL;
+    }
+    for (int w = 1, b = 0; ok && w <= cpus; w++) {
+        if (width_count[w] == 0) {
+            continue;
+        }
+        g.buckets[b].width = w;
+        g.buckets[b].jobs = malloc(sizeof(int) * width_count[w]);
+        ok = g.buckets[b].jobs != NULL && tree_init(&g.buckets[b].tree, width_count[w]);
+        width_count[w] = b++;   // Now the bucket index for this width
+    }
+    for (int j = 0; ok && j < n; j++) {
+        GangBucket *bucket = &g.buckets[width_count[jobs[j].width]];
+        jobs[j].bucket = width_count[jobs[j].width];
+        jobs[j].slot = bucket->count;
+        bucket->jobs[bucket->count++] = j;
+    }
+    free(width_count);
+
+    progress_begin(gang_policy_name(policy), n);
+    long long now = 0, busy_area = 0, idle_waiting_area = 0;
+    int done = 0;
+    double sum_wait = 0, sum_turnaround = 0, sum_slowdown = 0;
+
+    while (ok && done < n) {
+        long long next = LLONG_MAX;
+        if (g.arrived < n) {
+            next = jobs[g.arrived].arrival;
+        }
+        if (g.running_count > 0 && g.running[g.running_count - 1].end < next) {
+            next = g.running[g.running_count - 1].end;
+        }
+
+        // Idle CPUs while jobs wait are fragmentation
+        long long span = next - now;
+        busy_area += (long long)(cpus - g.free) * span;
+        if (g.waiting > 0) {
+            idle_waiting_area += (long long)g.free * span;
+        }
+        INSTR_READY(g.waiting, span);
+        now = next;
+
+        while (g.running_count > 0 && g.running[g.running_count - 1].end == now) {
+            RunningJob *r = &g.running[--g.running_count];
+            GangJob *job = &jobs[r->job];
+            g.free += r->width;
+            done++;
+
+            long long wait = job->start - job->arrival;
+            long long turnaround = job->end - job->arrival;
+            long long floor = job->runtime > GANG_SLOWDOWN_TAU ? job->runtime : GANG_SLOWDOWN_TAU;
+            double slowdown = (double)turnaround / floor;
+            if (slowdown < 1.0) {
+                slowdown = 1.0;
+            }
+            sum_wait += wait;
+            sum_turnaround += turnaround;
+            sum_slowdown += slowdown;
+            if (slowdown > stats->max_slowdown) {
+                stats->max_slowdown = slowdown;
+            }
+            if (monitor_enabled) {
+                progress_tick(done, now);
+            }
+        }
+
+        while (g.arrived < n && jobs[g.arrived].arrival == now) {
+            GangJob *job = &jobs[g.arrived++];
+            tree_set(&g.buckets[job->bucket].tree, job->slot, job->runtime);
+            g.waiting++;
+            if (g.waiting > stats->max_waiting) {
+                stats->max_waiting = g.waiting;
+            }
+        }
+
+        gang_schedule(&g, policy, now, stats);
+    }
+
+    INSTR_END();
+    progress_end();
+    for (int b = 0; b < g.bucket_count && g.buckets != NULL; b++) {
+        free(g.buckets[b].jobs);
+        free(g.buckets[b].tree.value);
+    }
+    free(g.buckets);
+    free(g.running);
+
+    if (!ok) {
+        return false;
+    }
+    stats->jobs = n;
+    stats->makespan = now;
+    if (n > 0) {
+        stats->avg_waiting = sum_wait / n;
+        stats->avg_turnaround = sum_turnaround / n;
+        stats->avg_slowdown = sum_slowdown / n;
+    }
+    if (now > 0) {
+        stats->utilization = 100.0 * busy_area / ((double)cpus * now);
+        stats->fragmentation = 100.0 * idle_waiting_area / ((double)cpus * now);
+    }
+    return true;
+}
+
+// Run the loaded processes as gang jobs and write the results back
+bool gang_processes(Process processes[], int n, int cpus, int policy,
+                    Metrics *metrics, GangStats *stats) {
+    GangJob jobs[MAX_PROCESSES];
+    for (int i = 0; i < n; i++) {
+        jobs[i].id = i;
+        jobs[i].arrival = processes[i].arrival_time;
+        jobs[i].runtime = processes[i].burst_time;
+        jobs[i].width = processes[i].width;
+    }
+    if (!gang_simulate(jobs, n, cpus, policy, stats)) {
+        return false;
+    }
+
+    for (int k = 0; k < n; k++) {
+        Process *p = &processes[jobs[k].id];
+        p->remaining_time = 0;
+        p->completion_time = (int)jobs[k].end;
+        p->turnaround_time = p->completion_time - p->arrival_time;
+        p->waiting_time = p->turnaround_time - p->burst_time;
+        p->response_time = p->waiting_time;
+        p->first_response = true;
+    }
+    calculate_metrics(processes, n, (int)stats->makespan, metrics);
+    metrics->cpu_utilization = stats->utilization;
+    return true;
+}
+
+// Any number of jobs from a workload file ("arrival burst priority
+// [class] [width]"), into a growable array
+GangJob *load_gang_file(const char *filename, int *n) {
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        return NULL;
+    }
+
+    int capacity = 1024;
+    GangJob *jobs = malloc(sizeof(GangJob) * capacity);
+    char line[256];
+    *n = 0;
+
+    while (jobs != NULL && fgets(line, sizeof(line), fp) != NULL) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        long long arrival;
+        int burst, priority, proc_class, width;
+        int fields = sscanf(line, "%lld %d %d %d %d", &arrival, &burst, &priority, &proc_class, &width);
+        if (fields < 3 || arrival < 0 || burst <= 0 || *n == INT_MAX) {
+            continue;
+        }
+        if (*n == capacity) {
+            GangJob *grown = realloc(jobs, sizeof(GangJob) * capacity * 2);
+            if (grown == NULL) {
+                free(jobs);
+                jobs = NULL;
+                break;
+            }
+            jobs = grown;
+            capacity *= 2;
+        }
+        GangJob *job = &jobs[*n];
+        job->id = *n;
+        job->arrival = arrival;
+        job->runtime = burst;
+        job->width = (fields >= 5 && width > 0) ? width : 1;
+        (*n)++;
+    }
+    fclose(fp);
+    return jobs;
+}
+
+// Synthetic batch: power-of-two widths (equally likely exponents),
+// lognormal runtimes, Poisson arrivals at the offered load (0 = every job
+// submitted at time 0)
+GangJob *generate_gang_jobs(int n, int cpus, double load, uint64_t seed) {
+    GangJob *jobs = malloc(sizeof(GangJob) * (n > 0 ? n : 1));
+    if (jobs == NULL) {
+        return NULL;
+    }
+    uint64_t rng = seed ? seed : 1;
+    int max_log = 0;
+    while ((2 << max_log) <= cpus) {
+        max_log++;
+    }
+
+    double mean_runtime = 100.0, sigma = 1.0;
+    double mean_width = 0;
+    for (int k = 0; k <= max_log; k++) {
+        mean_width += (double)(1 << k) / (max_log + 1);
+    }
+    double rate = load * cpus / (mean_runtime * mean_width);
+
+    double clock = 0;
+    for (int i = 0; i < n; i++) {
+        if (load > 0) {
+            clock += rng_exponential(&rng, rate);
+        }
+        double runtime = exp(log(mean_runtime) - sigma * sigma / 2.0 + sigma * rng_normal(&rng));
+        jobs[i].id = i;
+        jobs[i].arrival = (long long)clock;
+        jobs[i].runtime = runtime < 1.0 ? 1 : (long long)(runtime + 0.5);
+        jobs[i].width = 1 << (int)(rng_next(&rng) % (max_log + 1));
+    }
+    return jobs;
+}
+
+void print_gang_stats(FILE *fp, int cpus, int policy, const GangStats *stats) {
+    fprintf(fp, "\n=== %s on %d CPUs: %lld jobs ===\n", gang_policy_name(policy), cpus, stats->jobs);
+    fprintf(fp, "Makespan:              %lld\n", stats->makespan);
+    fprintf(fp, "CPU Utilization:       %.2f%%\n", stats->utilization);
+    fprintf(fp, "Fragmentation:         %.2f%% (idle CPU-time while jobs wait)\n", stats->fragmentation);
+    fprintf(fp, "Avg Waiting Time:      %.2f\n", stats->avg_waiting);
+    fprintf(fp, "Avg Turnaround Time:   %.2f\n", stats->avg_turnaround);
+    fprintf(fp, "Bounded Slowdown:      %.2f avg, %.2f max (tau = %d)\n",
+            stats->avg_slowdown, stats->max_slowdown, GANG_SLOWDOWN_TAU);
+    fprintf(fp, "Backfilled jobs:       %lld\n", stats->backfilled);
+    fprintf(fp, "Peak queue length:     %d\n", stats->max_waiting);
+}
+
+void gang_menu(Process processes[], int n) {
+    int cpus;
+    printf("\nNumber of CPUs (1-%d): ", MAX_GANG_CPUS);
+    if (scanf("%d", &cpus) != 1 || cpus < 1 || cpus > MAX_GANG_CPUS) {
+        printf("⚠ Invalid number of CPUs!\n");
+        return;
+    }
+
+    printf("\nJobs:\n");
+    printf("1. Loaded processes (width from workload file column 5)\n");
+    printf("2. Workload file (any size)\n");
+    printf("3. Generate a synthetic batch\n");
+    printf("Choice: ");
+    int source;
+    if (scanf("%d", &source) != 1 || source < 1 || source > 3) {
+        printf("⚠ Invalid choice!\n");
+        return;
+    }
+
+    GangJob *jobs = NULL;
+    int count = 0;
+    if (source == 1) {
+        if (n == 0) {
+            printf("⚠ No processes loaded! Please add processes first.\n");
+            return;
+        }
+        count = n;
+    } else if (source == 2) {
+        char filename[256];
+        printf("Workload file: ");
+        if (scanf("%255s", filename) != 1) {
+            return;
+        }
+        jobs = load_gang_file(filename, &count);
+        if (jobs == NULL || count == 0) {
+            printf("⚠ Could not read jobs from '%s'!\n", filename);
+            free(jobs);
+            return;
+        }
+    } else {
+        double load;
+        unsigned long long seed;
+        printf("Number of jobs: ");
+        if (scanf("%d", &count) != 1 || count <= 0) {
+            printf("⚠ Invalid number of jobs!\n");
+            return;
+        }
+        printf("Offered load (0 = all submitted at time 0, e.g. 0.9): ");
+        if (scanf("%lf", &load) != 1 || load < 0) {
+            printf("⚠ Invalid load!\n");
+            return;
+        }
+        printf("Random seed: ");
+        if (scanf("%llu", &seed) != 1) {
+            printf("⚠ Invalid seed!\n");
+            return;
+        }
+        jobs = generate_gang_jobs(count, cpus, load, seed);
+        if (jobs == NULL) {
+            printf("⚠ Out of memory!\n");
+            return;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        int width = source == 1 ? processes[i].width : jobs[i].width;
+        if (width > cpus) {
+            printf("⚠ Job %d needs %d CPUs but only %d are available!\n", i + 1, width, cpus);
+            free(jobs);
+            return;
+        }
+    }
+
+    printf("\nPolicy:\n");
+    printf("1. Gang FCFS (strict queue order)\n");
+    printf("2. EASY backfilling\n");
+    printf("3. First-fit packing\n");
+    printf("4. Compare all three\n");
+    printf("Choice: ");
+    int choice;
+    if (scanf("%d", &choice) != 1 || choice < 1 || choice > 4) {
+        printf("⚠ Invalid choice!\n");
+        free(jobs);
+        return;
+    }
+
+    int first = choice == 4 ? GANG_FCFS : choice;
+    int last = choice == 4 ? GANG_FIRST_FIT : choice;
+    GangJob *copy = source == 1 ? NULL : malloc(sizeof(GangJob) * count);
+    if (source != 1 && copy == NULL) {
+        printf("⚠ Out of memory!\n");
+        free(jobs);
+        return;
+    }
+
+    for (int policy = first; policy <= last; policy++) {
+        GangStats stats;
+        Metrics metrics;
+        bool ok;
+        clock_t start = clock();
+
+        if (source == 1) {
+            Process proc_copy[MAX_PROCESSES];
+            reset_processes(processes, proc_copy, n);
+            ok = gang_processes(proc_copy, n, cpus, policy, &metrics, &stats);
+            if (ok && choice != 4) {
+                print_results(proc_copy, n, metrics, gang_policy_name(policy));
+                save_to_file(proc_copy, n, metrics, gang_policy_name(policy));
+            }
+        } else {
+            memcpy(copy, jobs, sizeof(GangJob) * count);
+            ok = gang_simulate(copy, count, cpus, policy, &stats);
+        }
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        if (!ok) {
+            printf("⚠ Out of memory!\n");
+            break;
+        }
+        print_gang_stats(stdout, cpus, policy, &stats);
+        printf("Simulation time:       %.3f s\n", seconds);
+
+        FILE *fp = fopen("scheduling_results.txt", "a");
+        if (fp != NULL) {
+            print_gang_stats(fp, cpus, policy, &stats);
+            fclose(fp);
+        }
+    }
+
+    free(copy);
+    free(jobs);
+}